@@ -0,0 +1,454 @@
+/**********************
+
+  Benchmark of primitives in "../common" (checksum, memory access, SW clock, stdio)
+
+  Functionality:
+    - initialization:
+      - set fCPU=16MHz, start SW clock (TIM4) and cycle counter (TIM2)
+      - configure UART @ 115.2kBaud / 8N1
+    - run each benchmark BENCH_RUNS times and measure CPU cycles via PERF_BEGIN()/PERF_END()
+      - checksum over flash: range function vs. loop over single bytes (CRC16, Fletcher-16)
+      - memory access: read_1B_far() loop vs. read_block_far(), read_2B_far(), read_4B_far()
+      - SW clock: micros(), millis(), uptime_ms48(), and previous micros()/millis() which stop TIM4 or disable its interrupt
+      - stdio: putchar(), printf() with 32 characters
+    - optional (BENCH_MEMORY_STRESS): TIM3 ISR reads/writes via read_1B_far()/write_1B_far() while main
+      loop reads flash via read_block_far(). Check that neither is corrupted by preemption
+    - print machine-parsable result table, then idle
+
+  Supported Hardware:
+    - Nucleo 8S207K8
+    - ucsim STM8 simulator, see "Readme.txt"
+
+  Note:
+    - alternative implementations are selected via one [env] per variant in "platformio.ini", e.g. CRC16_CCITT_IMPL,
+      UART_STDIO_PORT or UART_TX_BUFFER_SIZE. Compare tables of different builds to find regressions
+    - min. values exclude interrupts (TIM2, TIM4), avg. values include them
+    - putchar() is measured with empty UART, printf() includes waiting for UART (blocking output)
+
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "stm8s.h"
+#include "stm8s_it.h"     // required here by SDCC for ISR
+#include "stm8s_clk.h"
+#include "stm8s_uart3.h"
+#include "stm8s_tim3.h"
+#include "stdio.h"
+#include "string.h"
+#define _MAIN_            // required for global variables
+  #include "sw_clock.h"
+  #include "uart_stdio.h"
+  #include "perf_counter.h"
+#undef _MAIN_
+#include "memory_access.h"
+#include "checksum_crc16.h"
+#include "checksum_fletcher16.h"
+
+
+/*----------------------------------------------------------
+    MACROS / DEFINES
+----------------------------------------------------------*/
+
+// communication speed [Baud]
+#define BAUDRATE        115200L
+
+// number of runs per benchmark
+#define BENCH_RUNS      8
+
+// number of bytes for checksum and memory access benchmarks
+#define BENCH_BYTES     1024
+
+// start addresses for benchmarks. Far address is above 64kB
+#define BENCH_ADDR      0x8000
+#define BENCH_ADDR_FAR  0x10000
+
+// benchmark ids (= index in g_perfTable). Must be < PERF_NUM_IDS
+#define ID_CRC16_RANGE        0
+#define ID_CRC16_UPDATE       1
+#define ID_FLETCHER16_RANGE   2
+#define ID_FLETCHER16_UPDATE  3
+#define ID_READ_1B_FAR        4
+#define ID_READ_BLOCK_FAR     5
+#define ID_READ_2B_FAR        6
+#define ID_READ_4B_FAR        7
+#define ID_MICROS             8
+#define ID_MILLIS             9
+#define ID_UPTIME_MS48        10
+#define ID_PUTCHAR            11
+#define ID_PRINTF             12
+#define ID_MICROS_STOP        13
+#define ID_MILLIS_IRQ         14
+#define NUM_BENCH             15
+
+#if (NUM_BENCH > PERF_NUM_IDS)
+  #error PERF_NUM_IDS too small for benchmark, see "platformio.ini"
+#endif
+
+// memory access stress test: number of read_block_far() calls, and TIM3 ISR period [cycles].
+// Period is prime, i.e. ISR preempts main loop at varying instructions
+#define STRESS_LOOPS          500
+#define STRESS_PERIOD         397
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// benchmark names and units (bytes or calls) per run. Order as ids above
+const char      *benchName[NUM_BENCH] = {
+  "crc16_ccitt_range", "crc16_ccitt_update", "fletcher16_chk_range", "fletcher16_chk_update",
+  "read_1B_far", "read_block_far", "read_2B_far", "read_4B_far",
+  "micros", "millis", "uptime_ms48", "putchar", "printf_32B",
+  "micros_stop_tim4", "millis_irq_off"
+};
+const uint16_t  benchUnits[NUM_BENCH] = {
+  BENCH_BYTES, BENCH_BYTES, BENCH_BYTES, BENCH_BYTES,
+  BENCH_BYTES, BENCH_BYTES, BENCH_BYTES/2, BENCH_BYTES/4,
+  1, 1, 1, 1, 32,
+  1, 1
+};
+
+// buffer for block read
+uint8_t           buf[BENCH_BYTES];
+
+// result sink, avoids that compiler removes benchmarked code
+volatile uint32_t sink;
+
+#if defined(BENCH_MEMORY_STRESS)
+
+  // data copied by TIM3 ISR from flash (behind benchmark range) to RAM via read_1B_far()/write_1B_far()
+  volatile uint8_t  g_stressBuf[256];
+  volatile uint8_t  g_stressIdx = 0;
+
+  // number of TIM3 ISR calls and ISR read-back errors
+  volatile uint32_t g_stressCalls = 0;
+  volatile uint16_t g_stressErrors = 0;
+
+#endif // BENCH_MEMORY_STRESS
+
+
+/////////////////
+// baseline micros() for comparison: briefly stop TIM4 and disable TIM4 interrupt (replaced by lock-free read)
+/////////////////
+static inline uint32_t micros_stop_tim4(void)
+{
+  uint8_t   cnt, uif, oldTIM4_IER;
+  uint32_t  us;
+
+  // stop TIM4 for consistent counter and overflow flag
+  TIM4->CR1 &= (uint8_t) ~TIM4_CR1_CEN;
+  cnt = TIM4->CNTR;
+  uif = TIM4->SR1;
+  TIM4->CR1 |= TIM4_CR1_CEN;
+
+  // copy micros with TIM4 interrupt disabled
+  oldTIM4_IER = TIM4->IER;
+  TIM4->IER &= (uint8_t) ~TIM4_IT_UPDATE;
+  us = g_micros;
+  TIM4->IER = oldTIM4_IER;
+
+  // add counter value and pending overflow
+  us += ((uint16_t) cnt) << 2;
+  if (uif & 0x01)
+    us += 1000L;
+
+  return(us);
+
+} // micros_stop_tim4()
+
+
+
+/////////////////
+// baseline millis() for comparison: disable TIM4 interrupt (replaced by lock-free read)
+/////////////////
+static inline uint32_t millis_irq_off(void)
+{
+  uint8_t   oldTIM4_IER;
+  uint32_t  ms;
+
+  oldTIM4_IER = TIM4->IER;
+  TIM4->IER &= (uint8_t) ~TIM4_IT_UPDATE;
+  ms = g_millis;
+  TIM4->IER = oldTIM4_IER;
+
+  return(ms);
+
+} // millis_irq_off()
+
+
+
+/////////////////
+// run all benchmarks once
+/////////////////
+void run_benchmarks(void)
+{
+  uint16_t  chk, hi, i;
+  uint32_t  lo;
+
+
+  //////////
+  // checksums over flash
+  //////////
+  PERF_BEGIN(ID_CRC16_RANGE);
+  chk = crc16_ccitt_range(BENCH_ADDR, BENCH_ADDR+BENCH_BYTES-1);
+  PERF_END(ID_CRC16_RANGE);
+  sink = chk;
+
+  PERF_BEGIN(ID_CRC16_UPDATE);
+  chk = crc16_ccitt_initialize();
+  for (i = 0; i < BENCH_BYTES; i++)
+    chk = crc16_ccitt_update(chk, read_1B_far(BENCH_ADDR + i));
+  chk = crc16_ccitt_finalize(chk);
+  PERF_END(ID_CRC16_UPDATE);
+  sink = chk;
+
+  PERF_BEGIN(ID_FLETCHER16_RANGE);
+  chk = fletcher16_chk_range(BENCH_ADDR, BENCH_ADDR+BENCH_BYTES-1);
+  PERF_END(ID_FLETCHER16_RANGE);
+  sink = chk;
+
+  PERF_BEGIN(ID_FLETCHER16_UPDATE);
+  chk = fletcher16_chk_initialize();
+  for (i = 0; i < BENCH_BYTES; i++)
+    chk = fletcher16_chk_update(chk, read_1B_far(BENCH_ADDR + i));
+  chk = fletcher16_chk_finalize(chk);
+  PERF_END(ID_FLETCHER16_UPDATE);
+  sink = chk;
+
+
+  //////////
+  // memory access above 64kB
+  //////////
+  PERF_BEGIN(ID_READ_1B_FAR);
+  for (i = 0; i < BENCH_BYTES; i++)
+    buf[i] = read_1B_far(BENCH_ADDR_FAR + i);
+  PERF_END(ID_READ_1B_FAR);
+
+  PERF_BEGIN(ID_READ_BLOCK_FAR);
+  read_block_far(BENCH_ADDR_FAR, buf, BENCH_BYTES);
+  PERF_END(ID_READ_BLOCK_FAR);
+
+  PERF_BEGIN(ID_READ_2B_FAR);
+  for (i = 0; i < BENCH_BYTES; i += 2)
+    sink = read_2B_far(BENCH_ADDR_FAR + i);
+  PERF_END(ID_READ_2B_FAR);
+
+  PERF_BEGIN(ID_READ_4B_FAR);
+  for (i = 0; i < BENCH_BYTES; i += 4)
+    sink = read_4B_far(BENCH_ADDR_FAR + i);
+  PERF_END(ID_READ_4B_FAR);
+
+
+  //////////
+  // SW clock
+  //////////
+  PERF_BEGIN(ID_MICROS);
+  lo = micros();
+  PERF_END(ID_MICROS);
+  sink = lo;
+
+  PERF_BEGIN(ID_MILLIS);
+  lo = millis();
+  PERF_END(ID_MILLIS);
+  sink = lo;
+
+  PERF_BEGIN(ID_UPTIME_MS48);
+  uptime_ms48(&hi, &lo);
+  PERF_END(ID_UPTIME_MS48);
+  sink = lo + hi;
+
+  PERF_BEGIN(ID_MICROS_STOP);
+  lo = micros_stop_tim4();
+  PERF_END(ID_MICROS_STOP);
+  sink = lo;
+
+  PERF_BEGIN(ID_MILLIS_IRQ);
+  lo = millis_irq_off();
+  PERF_END(ID_MILLIS_IRQ);
+  sink = lo;
+
+
+  //////////
+  // stdio. Start with empty UART. Output is a comment line of result table
+  //////////
+  uart_flush();
+  PERF_BEGIN(ID_PUTCHAR);
+  putchar('.');
+  PERF_END(ID_PUTCHAR);
+
+  uart_flush();
+  PERF_BEGIN(ID_PRINTF);
+  printf("# 23456789012345678901234567890\n");
+  PERF_END(ID_PRINTF);
+
+} // run_benchmarks()
+
+
+
+#if defined(BENCH_MEMORY_STRESS)
+
+/////////////////
+// memory stress handler. Called from TIM3 ISR in stm8s_it.c
+/////////////////
+void ISR_memory_stress(void)
+{
+  uint8_t   val;
+
+  // clear TIM3 update flag
+  TIM3->SR1 = (uint8_t) (~TIM3_SR1_UIF);
+
+  // copy byte from flash >64kB to RAM via far access, and read back
+  val = read_1B_far(BENCH_ADDR_FAR + BENCH_BYTES + g_stressIdx);
+  write_1B_far((uint16_t) &(g_stressBuf[g_stressIdx]), val);
+  if (read_1B_far((uint16_t) &(g_stressBuf[g_stressIdx])) != val)
+    g_stressErrors++;
+
+  g_stressIdx++;
+  g_stressCalls++;
+
+} // ISR_memory_stress()
+
+
+
+/////////////////
+// memory stress test: read_block_far() in main loop, preempted by far accesses in TIM3 ISR
+/////////////////
+void run_memory_stress(void)
+{
+  uint16_t  ref, loop, errMain = 0, errIsr = 0;
+  uint16_t  i;
+
+  // reference checksum. TIM3 ISR not yet active
+  read_block_far(BENCH_ADDR_FAR, buf, BENCH_BYTES);
+  ref = crc16_ccitt_block(crc16_ccitt_initialize(), buf, BENCH_BYTES);
+
+  // start TIM3 ISR with prime period
+  TIM3_TimeBaseInit(TIM3_PRESCALER_1, STRESS_PERIOD-1);
+  TIM3_ClearFlag(TIM3_FLAG_UPDATE);
+  TIM3_ITConfig(TIM3_IT_UPDATE, ENABLE);
+  TIM3_Cmd(ENABLE);
+
+  // read flash block and compare with reference
+  for (loop = 0; loop < STRESS_LOOPS; loop++)
+  {
+    memset(buf, 0, BENCH_BYTES);
+    read_block_far(BENCH_ADDR_FAR, buf, BENCH_BYTES);
+    if (crc16_ccitt_block(crc16_ccitt_initialize(), buf, BENCH_BYTES) != ref)
+      errMain++;
+  }
+
+  // stop TIM3 ISR
+  TIM3_ITConfig(TIM3_IT_UPDATE, DISABLE);
+  TIM3_Cmd(DISABLE);
+
+  // check data copied by ISR
+  for (i = 0; i < 256; i++)
+  {
+    if (g_stressBuf[i] != read_1B_far(BENCH_ADDR_FAR + BENCH_BYTES + i))
+      errIsr++;
+  }
+  errIsr += g_stressErrors;
+
+  // print result. Is "pass" only without errors and if ISR has preempted main loop
+  printf("# memory stress: loops=%d, ISR calls=%ld, errors main=%d, errors ISR=%d\n", (int) STRESS_LOOPS,
+    (long) g_stressCalls, (int) errMain, (int) errIsr);
+  printf("STRESS\tmemory_access\t%s\n", ((errMain == 0) && (errIsr == 0) && (g_stressCalls > 256)) ? "pass" : "fail");
+
+} // run_memory_stress()
+
+#endif // BENCH_MEMORY_STRESS
+
+
+
+/////////////////
+// print result table
+/////////////////
+void print_results(void)
+{
+  perf_entry_t  *entry = g_perfTable;
+  uint32_t      avg;
+  uint8_t       i;
+
+  // build options as comments
+  printf("\n# benchmark: fMASTER=16000000, runs=%d, CRC16_CCITT_IMPL=%d, UART_STDIO_PORT=%d, UART_TX_BUFFER_SIZE=%d\n",
+    (int) BENCH_RUNS, (int) CRC16_CCITT_IMPL, (int) UART_STDIO_PORT, (int) UART_TX_BUFFER_SIZE);
+  printf("# name\tunits\truns\tmin\tmax\tavg\tavg/unit*100 [cycles]\n");
+
+  // one line per benchmark
+  for (i = 0; i < NUM_BENCH; i++, entry++)
+  {
+    avg = (entry->count != 0) ? (entry->total / entry->count) : 0;
+    printf("BENCH\t%s\t%d\t%ld\t%ld\t%ld\t%ld\t%ld\n", benchName[i], (int) benchUnits[i], (long) entry->count,
+      (long) entry->min, (long) entry->max, (long) avg, (long) ((avg * 100) / benchUnits[i]));
+  }
+
+  // end marker, e.g. for scripts
+  printf("# end\n");
+
+} // print_results()
+
+
+
+/////////////////
+//  main routine
+/////////////////
+void main(void)
+{
+  uint8_t   i;
+
+
+  /////////////
+  // initialization
+  /////////////
+
+  // disable interrupts
+  disableInterrupts();
+
+  // set HSI and HSE prescaler to 1 and fCPU=fMaster
+  CLK->CKDIVR = 0x00;
+  CLK_SYSCLKConfig(CLK_PRESCALER_CPUDIV1);
+
+  // start 1ms clock via TIM4
+  init_SW_clock();
+
+  // Configure UART3 for 115kBaud, 8N1
+  UART3_Init(BAUDRATE, UART3_WORDLENGTH_8D, UART3_STOPBITS_1, UART3_PARITY_NO, UART3_MODE_TXRX_ENABLE);
+
+  // bind stdio input/output to UART3. Only used for UART_STDIO_PORT=0
+  g_UART_SendData8 = &UART3_SendData8;
+  g_UART_ReceiveData8 = &UART3_ReceiveData8;
+  g_UART_GetFlagStatus = &UART3_GetFlagStatus;
+  g_UART_ITConfig = &UART3_ITConfig;
+
+  // enable interrupts
+  enableInterrupts();
+
+  // start TIM2 cycle counter and measure overhead
+  perf_init();
+
+
+  /////////////
+  // run benchmarks and print results
+  /////////////
+  printf("\n# start benchmark\n");
+  for (i = 0; i < BENCH_RUNS; i++)
+    run_benchmarks();
+  #if defined(BENCH_MEMORY_STRESS)
+    run_memory_stress();
+  #endif
+  print_results();
+
+
+  /////////////
+  // main loop
+  /////////////
+  while (1);
+
+} // main()
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,145 @@
+/**
+  ******************************************************************************
+  * @file     stm8s_it.c
+  * @author   MCD Application Team
+  * @version  V2.0.4
+  * @date     26-April-2018
+  * @brief    Main Interrupt Service Routines.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2014 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */ 
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm8s_it.h"
+#include "sw_clock.h"
+#include "perf_counter.h"
+#include "uart_stdio.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+#if defined(BENCH_MEMORY_STRESS)
+  void ISR_memory_stress(void);     // memory access stress test, see main.c
+#endif
+/* Private functions ---------------------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+// Benchmark only requires handlers for TRAP, TIM2 (perf_counter), TIM3 (memory stress), UART3 (uart_stdio)
+// and TIM4 (sw_clock). Other interrupts are not enabled, see "stm8s_it.h"
+
+/** @addtogroup GPIO_Toggle
+  * @{
+  */
+#ifdef _COSMIC_
+/**
+  * @brief  Dummy interrupt routine
+  * @param  None
+  * @retval None
+  */
+INTERRUPT_HANDLER(NonHandledInterrupt, 25)
+{
+  /* In order to detect unexpected events during development,
+     it is recommended to set a breakpoint on the following instruction.
+  */
+}
+#endif /*_COSMIC_*/
+
+/**
+  * @brief  TRAP interrupt routine
+  * @param  None
+  * @retval None
+  */
+INTERRUPT_HANDLER_TRAP(TRAP_IRQHandler)
+{
+  /* In order to detect unexpected events during development,
+     it is recommended to set a breakpoint on the following instruction.
+  */
+}
+
+/**
+  * @brief  Timer2 Update/Overflow/Break Interrupt routine
+  * @param  None
+  * @retval None
+  */
+ INTERRUPT_HANDLER(TIM2_UPD_OVF_BRK_IRQHandler, 13)
+{
+  // call inline ISR handler from perf_counter.h
+  ISR_TIM2_handler();
+
+}
+
+/**
+  * @brief Timer3 Update/Overflow/Break Interrupt routine.
+  * @param  None
+  * @retval None
+  */
+ INTERRUPT_HANDLER(TIM3_UPD_OVF_BRK_IRQHandler, 15)
+{
+#if defined(BENCH_MEMORY_STRESS)
+  // call memory access stress handler from main.c
+  ISR_memory_stress();
+#endif
+
+}
+
+/**
+  * @brief  UART3 TX interrupt routine.
+  * @param  None
+  * @retval None
+  */
+ INTERRUPT_HANDLER(UART3_TX_IRQHandler, 20)
+{
+  // call inline ISR handler from uart_stdio.h
+  ISR_UART_TX_handler();
+
+}
+
+/**
+  * @brief  UART3 RX interrupt routine.
+  * @param  None
+  * @retval None
+  */
+ INTERRUPT_HANDLER(UART3_RX_IRQHandler, 21)
+{
+  // call inline ISR handler from uart_stdio.h
+  ISR_UART_RX_handler();
+
+}
+
+/**
+  * @brief  Timer4 Update/Overflow Interrupt routine.
+  * @param  None
+  * @retval None
+  */
+INTERRUPT_HANDLER(TIM4_UPD_OVF_IRQHandler, 23)
+{
+  // call inline ISR handler from sw_clock.h
+  ISR_TIM4_handler();
+
+}
+
+/**
+  * @}
+  */
+
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
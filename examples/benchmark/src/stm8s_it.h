@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file     stm8s_it.h
+  * @author   MCD Application Team
+  * @version  V2.0.4
+  * @date     26-April-2018
+  * @brief    This file contains the headers of the interrupt handlers
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2014 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */ 
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM8S_IT_H
+#define __STM8S_IT_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm8s.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+// only handlers used by benchmark, see "stm8s_it.c"
+#ifdef _COSMIC_
+ void _stext(void); /* RESET startup routine */
+ INTERRUPT void NonHandledInterrupt(void);
+#endif /* _COSMIC_ */
+
+// SDCC patch: requires separate handling for SDCC (see below)
+#if !defined(_RAISONANCE_) && !defined(_SDCC_)
+ INTERRUPT void TRAP_IRQHandler(void); /* TRAP */
+ INTERRUPT void TIM2_UPD_OVF_BRK_IRQHandler(void); /* TIM2 UPD/OVF/BRK */
+ INTERRUPT void TIM3_UPD_OVF_BRK_IRQHandler(void); /* TIM3 UPD/OVF/BRK */
+ INTERRUPT void UART3_TX_IRQHandler(void); /* UART3 TX */
+ INTERRUPT void UART3_RX_IRQHandler(void); /* UART3 RX */
+ INTERRUPT void TIM4_UPD_OVF_IRQHandler(void); /* TIM4 UPD/OVF */
+
+
+// SDCC patch: __interrupt keyword required after function name --> requires new block
+#elif defined (_SDCC_)
+
+ INTERRUPT_HANDLER_TRAP(TRAP_IRQHandler);                 /* TRAP */
+ INTERRUPT_HANDLER(TIM2_UPD_OVF_BRK_IRQHandler, 13);      /* TIM2 UPD/OVF/BRK */
+ INTERRUPT_HANDLER(TIM3_UPD_OVF_BRK_IRQHandler, 15);      /* TIM3 UPD/OVF/BRK */
+ INTERRUPT_HANDLER(UART3_TX_IRQHandler, 20);              /* UART3 TX */
+ INTERRUPT_HANDLER(UART3_RX_IRQHandler, 21);              /* UART3 RX */
+ INTERRUPT_HANDLER(TIM4_UPD_OVF_IRQHandler, 23);          /* TIM4 UPD/OVF */
+
+#endif /* !(_RAISONANCE_) && !(_SDCC_) */
+
+#endif /* __STM8S_IT_H */
+
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
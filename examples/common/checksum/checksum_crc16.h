@@ -20,6 +20,25 @@
 #include "memory_access.h"
 
 
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+// CRC16 calculation variants. Select via project options, e.g. "-DCRC16_CCITT_IMPL=CRC16_CCITT_LUT256"
+#define CRC16_CCITT_BITWISE     0     ///< bitwise calculation w/o lookup table (smallest, slowest)
+#define CRC16_CCITT_LUT16       1     ///< 16-entry nibble lookup table in flash (32B, for small devices)
+#define CRC16_CCITT_LUT256      2     ///< 256-entry byte lookup table in flash (512B, fastest)
+
+// default to bitwise calculation (smallest flash footprint)
+#if !defined(CRC16_CCITT_IMPL)
+  #define CRC16_CCITT_IMPL      CRC16_CCITT_BITWISE
+#endif
+
+#if (CRC16_CCITT_IMPL != CRC16_CCITT_BITWISE) && (CRC16_CCITT_IMPL != CRC16_CCITT_LUT16) && (CRC16_CCITT_IMPL != CRC16_CCITT_LUT256)
+  #error unknown CRC16_CCITT_IMPL, see checksum_crc16.h
+#endif
+
+
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL FUNCTIONS
 -----------------------------------------------------------------------------*/
@@ -33,6 +52,9 @@ uint16_t crc16_ccitt_update(uint16_t Chk, uint8_t Data);
 /// @brief finalize checksum value (CRC16_CCITT)
 #define  crc16_ccitt_finalize(Chk)   ( Chk )
 
+/// @brief update checksum value with data block in RAM (CRC16_CCITT)
+uint16_t crc16_ccitt_block(uint16_t Chk, const uint8_t *Data, uint16_t Len);
+
 /// @brief calculate checksum over address range (CRC16_CCITT)
 uint16_t crc16_ccitt_range(const uint32_t AddrStart, const uint32_t AddrEnd);
 
@@ -45,6 +45,71 @@ uint16_t fletcher16_chk_update(uint16_t Chk, uint8_t Data)
 } // fletcher16_chk_update()
 
 
+/**
+  \fn uint16_t fletcher16_chk_block(uint16_t Chk, const uint8_t *Data, uint16_t Len)
+   
+  \brief update checksum value with data block in RAM (Fletcher-16)
+
+  \param[in]  Chk   old checksum value
+  \param[in]  Data  pointer to data block
+  \param[in]  Len   number of bytes in block
+
+  \return updated checksum value
+
+  Update Fletcher-16 checksum value with a data block in RAM (16-bit address).
+  Sums are accumulated in 16 bits and reduced modulo 255 only every FLETCHER16_BLOCK_MAX bytes.
+  Result is identical to calling fletcher16_chk_update() for each byte.
+*/
+uint16_t fletcher16_chk_block(uint16_t Chk, const uint8_t *Data, uint16_t Len)
+{
+  // get individual checksums
+  uint16_t  sum1 = (uint8_t)(Chk);
+  uint16_t  sum2 = (uint8_t)(Chk >> 8);
+  uint8_t   n;
+
+  while (Len)
+  {
+    // number of bytes until next modulo reduction
+    n = (Len > FLETCHER16_BLOCK_MAX) ? FLETCHER16_BLOCK_MAX : (uint8_t) Len;
+    Len -= n;
+
+    // update individual checksums w/o modulo. 16-bit sums cannot overflow within FLETCHER16_BLOCK_MAX bytes
+    do
+    {
+      sum1 += *Data++;
+      sum2 += sum1;
+    } while (--n);
+
+    // reduce individual checksums
+    sum1 %= 255;
+    sum2 %= 255;
+
+  } // while (Len)
+
+  // return combined result
+  return (uint16_t)((sum2 << 8) | sum1);
+
+} // fletcher16_chk_block()
+
+
+/**
+  \fn void fletcher16_chk_chunk(void *Ctx, const uint8_t *Buf, uint8_t Len)
+   
+  \brief callback for read_range_far() in fletcher16_chk_range()
+
+  \param[in,out] Ctx   pointer to checksum value (uint16_t)
+  \param[in]     Buf   chunk of data in RAM
+  \param[in]     Len   number of bytes in chunk
+
+  Update Fletcher-16 checksum with chunk read via read_range_far()
+*/
+static void fletcher16_chk_chunk(void *Ctx, const uint8_t *Buf, uint8_t Len)
+{
+  *((uint16_t*) Ctx) = fletcher16_chk_block(*((uint16_t*) Ctx), Buf, Len);
+
+} // fletcher16_chk_chunk()
+
+
 /**
   \fn uint16_t fletcher16_chk_range(const uint32_t AddrStart, const uint32_t AddrEnd)
 
@@ -56,22 +121,18 @@ uint16_t fletcher16_chk_update(uint16_t Chk, uint8_t Data)
   \return Fletcher-16 checksum
   
   Calculate Fletcher-16 checksum over specified memory range. 
+  Memory is read in chunks via read_range_far() (see memory_access.h), and
+  sums are reduced modulo 255 only every FLETCHER16_BLOCK_MAX bytes, see fletcher16_chk_block()
 */
 uint16_t fletcher16_chk_range(const uint32_t AddrStart, const uint32_t AddrEnd)
 {
-	uint32_t  addr = AddrStart;
-	uint16_t  val;
-	uint16_t  sum1 = 0;
-  uint16_t  sum2 = 0;
+  uint16_t  chk;
 
-  while (addr <= AddrEnd)
-  {
-    val = (uint16_t) read_1B_far(addr++);
-    sum1 = (sum1 + val) % 255;
-    sum2 = (sum2 + sum1) % 255;
-  }
+  chk = fletcher16_chk_initialize();
+  read_range_far(AddrStart, AddrEnd, fletcher16_chk_chunk, &chk);
+  chk = fletcher16_chk_finalize(chk);
 
-  return (sum2 << 8) | sum1;
+  return chk;
 
 } // fletcher16_chk_range()
 
@@ -21,6 +21,14 @@
 #include "memory_access.h"
 
 
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// max. number of bytes between modulo reductions without overflow of 16-bit sums (255 + 255*n + 255*n*(n+1)/2 <= 0xFFFF)
+#define FLETCHER16_BLOCK_MAX        21
+
+
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL FUNCTIONS
 -----------------------------------------------------------------------------*/
@@ -34,6 +42,9 @@ uint16_t fletcher16_chk_update(uint16_t Chk, uint8_t Data);
 /// @brief finalize checksum value (Fletcher-16)
 #define fletcher16_chk_finalize(Chk) ( Chk )
 
+/// @brief update checksum value with data block in RAM (Fletcher-16)
+uint16_t fletcher16_chk_block(uint16_t Chk, const uint8_t *Data, uint16_t Len);
+
 /// @brief calculate checksum over specified range (Fletcher-16)
 uint16_t fletcher16_chk_range(const uint32_t AddrStart, const uint32_t AddrEnd);
 
@@ -0,0 +1,129 @@
+/**********************
+  implementation of incremental background checksum calculation.
+
+  Calculate a checksum over a memory range in small steps, e.g. from a 1ms task.
+  Each call processes as many bytes as fit into a given time budget [us], measured
+  with micros() from sw_clock.h. The calculation context (address, partial checksum,
+  algorithm) is kept between calls.
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "checksum_task.h"
+#include "sw_clock.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void checksum_task_init(checksum_task_t *Ctx, checksum_algo_t Algo, uint32_t AddrStart, uint32_t AddrEnd)
+
+  \brief initialize background checksum calculation
+
+  \param[out] Ctx         calculation context
+  \param[in]  Algo        checksum algorithm
+  \param[in]  AddrStart   first address (inclusive)
+  \param[in]  AddrEnd     last address (inclusive)
+
+  Initialize context for background checksum calculation over address range.
+  Requires SW clock to be running, see sw_clock.h
+*/
+void checksum_task_init(checksum_task_t *Ctx, checksum_algo_t Algo, uint32_t AddrStart, uint32_t AddrEnd)
+{
+  // store parameters
+  Ctx->algo      = Algo;
+  Ctx->addrStart = AddrStart;
+  Ctx->addrEnd   = AddrEnd;
+
+  // no completed pass yet
+  Ctx->result    = 0x0000;
+  Ctx->duration  = 0;
+  Ctx->passes    = 0;
+
+  // start first pass
+  Ctx->addr      = AddrStart;
+  Ctx->chk       = (Algo == CHK_CRC16) ? crc16_ccitt_initialize() : fletcher16_chk_initialize();
+  Ctx->tPass     = millis();
+
+} // checksum_task_init()
+
+
+
+/**
+  \fn bool checksum_task_run(checksum_task_t *Ctx, uint16_t Budget)
+
+  \brief continue background checksum calculation
+
+  \param[in,out] Ctx      calculation context
+  \param[in]     Budget   time budget for this call [us]
+
+  \return TRUE if a pass was completed in this call, else FALSE
+
+  Continue background checksum calculation in chunks of CHECKSUM_TASK_CHUNK bytes until
+  the time budget is used up. At least one chunk is processed per call. A new chunk is only
+  started if the previous chunk duration still fits into the remaining budget.
+  After a completed pass the result and pass duration are stored in the context, and the next
+  pass is started automatically with the next call.
+*/
+bool checksum_task_run(checksum_task_t *Ctx, uint16_t Budget)
+{
+  uint8_t   buf[CHECKSUM_TASK_CHUNK];
+  uint32_t  tStart, tLast, tNow;
+  uint32_t  remain;
+  uint8_t   len;
+
+  // start of time budget
+  tStart = micros();
+  tLast  = tStart;
+
+  while (1)
+  {
+    // number of bytes in next chunk
+    remain = Ctx->addrEnd - Ctx->addr;
+    len = (remain < CHECKSUM_TASK_CHUNK) ? (uint8_t) (remain + 1) : CHECKSUM_TASK_CHUNK;
+
+    // copy chunk to RAM
+    read_block_far(Ctx->addr, buf, len);
+    Ctx->addr += len;
+
+    // update checksum
+    if (Ctx->algo == CHK_CRC16)
+      Ctx->chk = crc16_ccitt_block(Ctx->chk, buf, len);
+    else
+      Ctx->chk = fletcher16_chk_block(Ctx->chk, buf, len);
+
+    // pass finished -> store result and restart
+    if (Ctx->addr > Ctx->addrEnd)
+    {
+      // store result and statistics
+      Ctx->result   = (Ctx->algo == CHK_CRC16) ? crc16_ccitt_finalize(Ctx->chk) : fletcher16_chk_finalize(Ctx->chk);
+      Ctx->duration = millis() - Ctx->tPass;
+      Ctx->passes++;
+
+      // start next pass
+      Ctx->addr  = Ctx->addrStart;
+      Ctx->chk   = (Ctx->algo == CHK_CRC16) ? crc16_ccitt_initialize() : fletcher16_chk_initialize();
+      Ctx->tPass = millis();
+
+      return TRUE;
+
+    } // pass finished
+
+    // stop if another chunk (with duration of last chunk) doesn't fit into remaining budget
+    tNow = micros();
+    if ((tNow - tStart) + (tNow - tLast) > Budget)
+      break;
+    tLast = tNow;
+
+  } // while (1)
+
+  return FALSE;
+
+} // checksum_task_run()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
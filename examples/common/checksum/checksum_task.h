@@ -0,0 +1,83 @@
+/**********************
+  declaration of incremental background checksum calculation.
+
+  Calculate a checksum over a memory range in small steps, e.g. from a 1ms task.
+  Each call processes as many bytes as fit into a given time budget [us], measured
+  with micros() from sw_clock.h. The calculation context (address, partial checksum,
+  algorithm) is kept between calls.
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CHECKSUM_TASK_H_
+#define _CHECKSUM_TASK_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+#include "memory_access.h"
+#include "checksum_crc16.h"
+#include "checksum_fletcher16.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// number of bytes processed between two time budget checks. Trade-off between micros() overhead and budget overshoot
+#if !defined(CHECKSUM_TASK_CHUNK)
+  #define CHECKSUM_TASK_CHUNK     16
+#endif
+#if (CHECKSUM_TASK_CHUNK < 1) || (CHECKSUM_TASK_CHUNK > 255)
+  #error CHECKSUM_TASK_CHUNK must be in range 1..255
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// checksum algorithm used for background calculation
+typedef enum
+{
+  CHK_FLETCHER16 = 0,               ///< Fletcher-16, see checksum_fletcher16.h
+  CHK_CRC16      = 1                ///< CRC16-CCITT, see checksum_crc16.h
+
+} checksum_algo_t;
+
+
+/// context of background checksum calculation
+typedef struct
+{
+  checksum_algo_t   algo;           ///< used checksum algorithm
+  uint32_t          addrStart;      ///< first address of range (inclusive)
+  uint32_t          addrEnd;        ///< last address of range (inclusive)
+  uint32_t          addr;           ///< next address to process
+  uint16_t          chk;            ///< partial checksum of current pass
+  uint32_t          tPass;          ///< start time of current pass [ms]
+  uint16_t          result;         ///< checksum of last completed pass
+  uint32_t          duration;       ///< duration of last completed pass [ms] (= fault detection time)
+  uint16_t          passes;         ///< number of completed passes
+
+} checksum_task_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief initialize background checksum calculation over address range
+void checksum_task_init(checksum_task_t *Ctx, checksum_algo_t Algo, uint32_t AddrStart, uint32_t AddrEnd);
+
+/// @brief continue background checksum calculation for given time budget [us]. Return TRUE if a pass was completed
+bool checksum_task_run(checksum_task_t *Ctx, uint16_t Budget);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CHECKSUM_TASK_H_
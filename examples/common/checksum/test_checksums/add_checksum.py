@@ -0,0 +1,90 @@
+# -*- coding: utf-8 -*-
+"""
+Add flash checksum to Intel hex file after build, e.g. via PlatformIO extra script (see "flash_checksum")
+
+Functionality:
+  - read firmware *.ihx from linker
+  - fill unused flash in checksum range with a defined value. Default 0x75 is an illegal opcode,
+    i.e. runaway code in unused flash triggers a reset
+  - calculate checksum like crc16_ccitt_range() or fletcher16_chk_range() in "../checksum_*.c"
+    over range Start..End-2
+  - store checksum in last 2B of range (End-1..End, big endian like STM8) and write *.ihx
+
+Firmware then compares fletcher16_chk_range(Start, End-2) (or CRC16) with read_2B_far(End-1).
+
+Usage example:
+  python add_checksum.py firmware.ihx --start 0x8000 --end 0x17fff --method fletcher16
+
+@author: gicking @ Github
+"""
+
+import crc_lut
+import fletcher
+import image_file
+import argparse
+
+
+def add_checksum(Filename:str, Start:int=0x8000, End:int=0x17FFF, Method:str="fletcher16", Fill:int=0x75, Output:str=None) -> int:
+    """
+    Fill unused flash, calculate checksum and store it in last 2B of range
+
+    Args:
+        Filename (str): name of Intel hex file from linker
+        Start (int): first address of checksum range
+        End (int): last address of checksum range incl. 2B for stored checksum
+        Method (str): checksum method, 'fletcher16' or 'crc16' (CRC16-CCITT)
+        Fill (int): value for unused flash in range (default: illegal opcode 0x75)
+        Output (str): name of output file (default: overwrite input file)
+
+    Returns:
+        int: calculated checksum
+    """
+
+    # parameter check
+    if Method.lower() == "fletcher16":
+        fct_checksum = fletcher.calculate_fletcher16
+    elif Method.lower() == "crc16":
+        fct_checksum = crc_lut.calculate_crc16
+    else:
+        raise TypeError("Illegal parameter method: '" + str(Method) + "'")
+    if End - Start < 2:
+        raise ValueError("range 0x%x..0x%x too small" % (Start, End))
+
+    # read linker output. Slot for checksum must not be used
+    data = image_file.read_ihx(Filename)
+    for address in (End - 1, End):
+        if address in data:
+            raise ValueError("%s: checksum address 0x%x already used" % (Filename, address))
+
+    # fill unused flash in range. Data outside range (e.g. EEPROM, option bytes) is kept
+    for address in range(Start, End - 1):
+        data.setdefault(address, Fill)
+
+    # calculate checksum over range w/o stored checksum
+    image = bytearray(data[address] for address in range(Start, End - 1))
+    chk = fct_checksum(image)
+
+    # store checksum big endian and write file
+    data[End - 1] = (chk >> 8) & 0xFF
+    data[End]     = chk & 0xFF
+    image_file.write_ihx(Output if Output else Filename, data)
+
+    return chk
+
+
+
+if __name__ == '__main__':
+
+    # commandline parameters
+    parser = argparse.ArgumentParser(description="Fill unused flash and add checksum to Intel hex file")
+    parser.add_argument("filename", help="Intel hex file from linker (*.ihx, *.hex)")
+    parser.add_argument("-o", "--output", default=None, help="output file (default: overwrite input)")
+    parser.add_argument("--start", type=lambda x: int(x, 0), default=0x8000, help="first address of checksum range (default: 0x8000)")
+    parser.add_argument("--end", type=lambda x: int(x, 0), default=0x17FFF, help="last address of checksum range incl. stored checksum (default: 0x17fff)")
+    parser.add_argument("-m", "--method", default="fletcher16", choices=["fletcher16", "crc16"], help="checksum method (default: fletcher16)")
+    parser.add_argument("--fill", type=lambda x: int(x, 0), default=0x75, help="value of unused flash (default: 0x75 = illegal opcode)")
+    args = parser.parse_args()
+
+    # add checksum and print result
+    chk = add_checksum(args.filename, Start=args.start, End=args.end, Method=args.method, Fill=args.fill, Output=args.output)
+    print("%s 0x%04x over 0x%x..0x%x stored at 0x%x" % (args.method, chk, args.start, args.end - 2, args.end - 1))
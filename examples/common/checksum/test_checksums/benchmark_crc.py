@@ -0,0 +1,81 @@
+# -*- coding: utf-8 -*-
+"""
+Benchmark CRC16-CCITT-FALSE and CRC32 implementations on 64kB images
+
+Compared variants:
+  - crc.py: bitwise (only 1 image, very slow)
+  - crc_lut.py: lookup table, 1 byte per loop
+  - crc_slicing.py: slicing-by-4, slicing-by-8 and long integer folding
+  - binascii.crc_hqx() and zlib.crc32(): C implementation of Python standard library, as reference
+
+All results are checked vs. crc_lut.py. Prints time per image [ms] and throughput [MB/s].
+
+@author: gicking @ Github
+"""
+
+import crc
+import crc_lut
+import crc_slicing
+import zlib
+import binascii
+import random
+import time
+
+
+def benchmark(Name:str, Function, Images:list, Reference:list):
+    """
+    Measure runtime of CRC function and compare results with reference
+
+    Args:
+        Name (str): name of variant for printing
+        Function (function): CRC function with image as parameter
+        Images (list): list of images (bytearray)
+        Reference (list): expected CRCs of images
+    """
+
+    # calculate CRC of all images and measure time
+    timeStart = time.perf_counter()
+    results = [Function(image) for image in Images]
+    timeEnd = time.perf_counter()
+
+    # check results vs. reference
+    errors = sum(1 for result, expected in zip(results, Reference) if result != expected)
+
+    # print time per image and throughput
+    duration = (timeEnd - timeStart) / len(Images)
+    print("%-28s %10.2f %10.2f    %s" % (Name, duration * 1000, len(Images[0]) / duration / 1e6, "ok" if errors == 0 else "%d errors" % errors))
+
+
+
+if __name__ == '__main__':
+
+    # set parameters
+    image_size = 65536          # image size [B]
+    num_images = 10             # number of random images
+
+    # reproducible random images
+    random.seed(42)
+    images = [bytearray(random.getrandbits(8) for _ in range(image_size)) for _ in range(num_images)]
+
+    # reference results from crc_lut.py
+    ref16 = [crc_lut.calculate_crc16(image) for image in images]
+    ref32 = [crc_lut.calculate_crc32(image) for image in images]
+
+    # benchmark CRC16-CCITT-FALSE
+    print("%d images of %dB\n" % (num_images, image_size))
+    print("%-28s %10s %10s    %s" % ("CRC16-CCITT-FALSE", "[ms]", "[MB/s]", "check"))
+    benchmark("crc.py (bitwise, 1 image)",  crc.calculate_crc16, images[:1], ref16[:1])
+    benchmark("crc_lut.py",                  crc_lut.calculate_crc16, images, ref16)
+    benchmark("slicing-by-4",                lambda data: crc_slicing.calculate_crc16_slicing(data, Slices=4), images, ref16)
+    benchmark("slicing-by-8",                lambda data: crc_slicing.calculate_crc16_slicing(data, Slices=8), images, ref16)
+    benchmark("folding",                     crc_slicing.calculate_crc16_fold, images, ref16)
+    benchmark("binascii.crc_hqx() (C)",      lambda data: binascii.crc_hqx(data, 0xFFFF), images, ref16)
+
+    # benchmark CRC32
+    print("\n%-28s %10s %10s    %s" % ("CRC32", "[ms]", "[MB/s]", "check"))
+    benchmark("crc.py (bitwise, 1 image)",  crc.calculate_crc32, images[:1], ref32[:1])
+    benchmark("crc_lut.py",                  crc_lut.calculate_crc32, images, ref32)
+    benchmark("slicing-by-4",                lambda data: crc_slicing.calculate_crc32_slicing(data, Slices=4), images, ref32)
+    benchmark("slicing-by-8",                lambda data: crc_slicing.calculate_crc32_slicing(data, Slices=8), images, ref32)
+    benchmark("folding",                     crc_slicing.calculate_crc32_fold, images, ref32)
+    benchmark("zlib.crc32() (C)",            zlib.crc32, images, ref32)
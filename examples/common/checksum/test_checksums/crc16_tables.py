@@ -0,0 +1,166 @@
+# -*- coding: utf-8 -*-
+"""
+Generate and check CRC16-CCITT lookup tables for checksum_crc16.c
+
+Prints the 256-entry (byte) and 16-entry (nibble) lookup tables as C arrays
+and checks that the table-driven algorithms used in checksum_crc16.c give the
+same results as crc.py (bitwise) and crc_lut.py (lookup table).
+Then checks the compiled C routines crc16_ccitt_update/block/range() of all
+CRC16_CCITT_IMPL variants via the host build (see host_lib.py).
+Exits with 1 on any error, e.g. for "make test" in ../../host.
+
+@author: gicking @ Github
+"""
+
+import sys
+import crc
+import crc_lut
+import host_lib
+
+
+def generate_crc16_lut(Poly:int=0x1021, Bits:int=8) -> list:
+    """
+    Calculate CRC16 lookup table for MSB-first processing of 'Bits' input bits.
+
+    Args:
+        Poly (int): polynomial used for CRC16 calculation
+        Bits (int): number of input bits per lookup (8=byte table, 4=nibble table)
+
+    Returns:
+        list: The CRC16 lookup table with 2^Bits entries.
+    """
+
+    # initialize table
+    crc_table = [0] * (1 << Bits)
+
+    # calculate LUT entries for given polynom
+    for divident in range(1 << Bits):
+        current_value = divident << (16 - Bits)
+        for _ in range(Bits):
+            if current_value & 0x8000:
+                current_value = (current_value << 1) ^ Poly
+            else:
+                current_value <<= 1
+        crc_table[divident] = current_value & 0xFFFF
+
+    return crc_table
+
+
+def calculate_crc16_lut256(Data:bytearray=None, Init:int=0xFFFF) -> int:
+    """
+    Calculate CRC16-CCITT like CRC16_CCITT_LUT256 in checksum_crc16.c
+
+    Args:
+        Data (bytearray): byte array to calculate checksum over
+        Init (int): inital value (0x00-0xFFFF)
+
+    Returns:
+        int: calculated CRC16 checksum.
+    """
+
+    lut = generate_crc16_lut(Bits=8)
+    crc = Init
+    for byte in Data:
+        crc = ((crc << 8) ^ lut[(crc >> 8) ^ byte]) & 0xFFFF
+    return crc
+
+
+def calculate_crc16_lut16(Data:bytearray=None, Init:int=0xFFFF) -> int:
+    """
+    Calculate CRC16-CCITT like CRC16_CCITT_LUT16 in checksum_crc16.c
+
+    Args:
+        Data (bytearray): byte array to calculate checksum over
+        Init (int): inital value (0x00-0xFFFF)
+
+    Returns:
+        int: calculated CRC16 checksum.
+    """
+
+    lut = generate_crc16_lut(Bits=4)
+    crc = Init
+    for byte in Data:
+        crc = ((crc << 4) ^ lut[(crc >> 12) ^ (byte >> 4)]) & 0xFFFF
+        crc = ((crc << 4) ^ lut[(crc >> 12) ^ (byte & 0x0F)]) & 0xFFFF
+    return crc
+
+
+def print_c_table(Name:str, Table:list):
+    """
+    Print lookup table as C array for copy & paste into checksum_crc16.c
+
+    Args:
+        Name (str): name of C array
+        Table (list): lookup table entries
+    """
+
+    print("static const uint16_t %s[%d] = {" % (Name, len(Table)))
+    lines = []
+    for i in range(0, len(Table), 8):
+        lines.append("    " + ", ".join("0x%04X" % val for val in Table[i:i+8]))
+    print(",\n".join(lines))
+    print("};\n")
+
+
+
+if __name__ == "__main__":
+
+    import random
+
+    # print lookup tables for checksum_crc16.c
+    print_c_table("crc16_ccitt_lut256", generate_crc16_lut(Bits=8))
+    print_c_table("crc16_ccitt_lut16", generate_crc16_lut(Bits=4))
+
+    # check vs. CRC16/CCITT-FALSE reference value from https://crccalc.com/
+    errors = 0
+    data = bytearray("123456789", 'utf-8')
+    chk = calculate_crc16_lut256(data)
+    print("check '123456789': 0x%04X (expect 0x29B1)" % chk)
+    if chk != 0x29B1:
+        errors += 1
+
+    # compare LUT variants with reference implementations for random data of random length
+    random.seed(42)
+    num_errors = errors
+    for _ in range(200):
+        data = bytearray(random.getrandbits(8) for _ in range(random.randint(0, 1024)))
+        ref = crc_lut.calculate_crc16(Data=data)
+        if (crc.calculate_crc16(Data=data) != ref) or (calculate_crc16_lut256(data) != ref) or (calculate_crc16_lut16(data) != ref):
+            errors += 1
+    print("random data: %d errors" % (errors - num_errors))
+
+    # check C implementation of all variants (host build): check value and random data at random address
+    for impl in range(3):
+        lib = host_lib.load_host_lib(impl)
+        num_errors = errors
+        for i in range(200):
+
+            # check value, also across 64kB bank boundary. Else random data at random address
+            if i == 0:
+                data = bytearray("123456789", 'utf-8')
+                addr = 0xFFFC
+            else:
+                data = bytearray(random.getrandbits(8) for _ in range(random.randint(1, 1024)))
+                addr = random.randint(0, host_lib.HOST_MEMORY_SIZE - len(data))
+            ref = 0x29B1 if i == 0 else crc_lut.calculate_crc16(Data=data)
+
+            # block in RAM
+            if lib.crc16_ccitt_block(0xFFFF, bytes(data), len(data)) != ref:
+                errors += 1
+
+            # bytewise update
+            chk = 0xFFFF
+            for val in data:
+                chk = lib.crc16_ccitt_update(chk, val)
+            if chk != ref:
+                errors += 1
+
+            # range in simulated memory
+            host_lib.write_memory(lib, addr, data)
+            if lib.crc16_ccitt_range(addr, addr + len(data) - 1) != ref:
+                errors += 1
+
+        print("C code CRC16_CCITT_IMPL=%d: %d errors" % (impl, errors - num_errors))
+
+    # return error for automated tests
+    sys.exit(1 if errors else 0)
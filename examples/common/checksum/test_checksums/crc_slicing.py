@@ -0,0 +1,349 @@
+# -*- coding: utf-8 -*-
+"""
+Fast CRC16 and CRC32 calculation for large images, e.g. precalculating firmware checksums
+
+Same results as crc_lut.py (CRC16-CCITT-FALSE, CRC32), but faster:
+  - slicing-by-4/8: 4 or 8 lookup tables, i.e. 4 or 8 bytes per loop instead of 1 byte
+  - folding: data is converted to a long integer via int.from_bytes() and the polynom
+    division is done on the long integer, i.e. in C. High part is repeatedly 'folded' into
+    low part via x^k mod poly. No Python loop over data bytes
+
+For CRC32 result equals zlib.crc32(), for CRC16-CCITT-FALSE binascii.crc_hqx(Data, 0xFFFF).
+For comparison of all variants see benchmark_crc.py
+
+@author: gicking @ Github
+"""
+
+import struct
+
+
+# slicing lookup tables, calculated on first call. Key is (width, poly, slices)
+__SLICING_LUT = {}
+
+# x^(2^m) mod poly for folding, calculated on first call. Key is (poly, width, m)
+__FOLD_POWER = {}
+
+# table for reversing bits in a byte
+__REVERSE_BITS = bytes(int('{:08b}'.format(i)[::-1], 2) for i in range(256))
+
+
+def reflect(Value:int, Width:int) -> int:
+    """
+    Reverse bit order of value.
+
+    Args:
+        Value (int): value to reflect
+        Width (int): number of bits
+
+    Returns:
+        int: reflected value.
+    """
+
+    return int('{:0{w}b}'.format(Value, w=Width)[::-1], 2)
+
+
+def __generate_crc16_slicing_lut(Poly:int, Slices:int) -> list:
+    """
+    Calculate CRC16 lookup tables for slicing-by-N (MSB first).
+    Table k contains the CRC of a byte followed by k zero bytes.
+
+    Args:
+        Poly (int): polynomial used for CRC16 calculation
+        Slices (int): number of tables (4 or 8)
+
+    Returns:
+        list: Slices tables with 256 entries each.
+    """
+
+    # standard byte table
+    lut = [[0] * 256 for _ in range(Slices)]
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ Poly) if (crc & 0x8000) else (crc << 1)
+        lut[0][i] = crc & 0xFFFF
+
+    # byte followed by k zero bytes
+    for k in range(1, Slices):
+        for i in range(256):
+            prev = lut[k-1][i]
+            lut[k][i] = ((prev << 8) & 0xFFFF) ^ lut[0][prev >> 8]
+
+    return lut
+
+
+def __generate_crc32_slicing_lut(Poly:int, Slices:int) -> list:
+    """
+    Calculate CRC32 lookup tables for slicing-by-N (reflected, LSB first).
+    Table k contains the CRC of a byte followed by k zero bytes.
+
+    Args:
+        Poly (int): polynomial used for CRC32 calculation (not reflected)
+        Slices (int): number of tables (4 or 8)
+
+    Returns:
+        list: Slices tables with 256 entries each.
+    """
+
+    # standard byte table with reflected polynom
+    poly = reflect(Poly, 32)
+    lut = [[0] * 256 for _ in range(Slices)]
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = ((crc >> 1) ^ poly) if (crc & 0x01) else (crc >> 1)
+        lut[0][i] = crc
+
+    # byte followed by k zero bytes
+    for k in range(1, Slices):
+        for i in range(256):
+            prev = lut[k-1][i]
+            lut[k][i] = (prev >> 8) ^ lut[0][prev & 0xFF]
+
+    return lut
+
+
+def calculate_crc16_slicing(Data:bytearray=None, Poly:int=0x1021, Init:int=0xFFFF, XorOut:int=0x0000, Slices:int=8) -> int:
+    """
+    Calculate CRC16 checksum (no reflection) via slicing-by-4 or slicing-by-8.
+    Default parameters are for CRC16-CCITT-FALSE in https://crccalc.com/
+
+    Args:
+        Data (bytearray): byte array to calculate checksum over
+        Poly (int): used polynom (0x00-0xFFFF)
+        Init (int): inital value (0x00-0xFFFF)
+        XorOut (int): final xor value (0x00-0xFFFF)
+        Slices (int): bytes per loop (4 or 8)
+
+    Returns:
+        int: calculated CRC16 checksum.
+    """
+
+    # parameter check
+    if not isinstance(Data, (bytes, bytearray)):
+        raise TypeError("Data must be of type bytes or bytearray.")
+    if Slices not in (4, 8):
+        raise ValueError("Slices must be 4 or 8.")
+
+    # get tables, calculate on first call
+    lut = __SLICING_LUT.get((16, Poly, Slices))
+    if lut is None:
+        lut = __generate_crc16_slicing_lut(Poly, Slices)
+        __SLICING_LUT[(16, Poly, Slices)] = lut
+    t0, t1, t2, t3 = lut[0], lut[1], lut[2], lut[3]
+
+    # init checksum
+    crc = Init
+    num = len(Data) - len(Data) % Slices
+
+    # 8 bytes per loop as big-endian 64-bit word. CRC is XORed to first 2 bytes
+    if Slices == 8:
+        t4, t5, t6, t7 = lut[4], lut[5], lut[6], lut[7]
+        for (val,) in struct.iter_unpack('>Q', memoryview(Data)[:num]):
+            val ^= crc << 48
+            crc = t7[val >> 56] ^ t6[(val >> 48) & 0xFF] ^ t5[(val >> 40) & 0xFF] ^ t4[(val >> 32) & 0xFF] ^ \
+                  t3[(val >> 24) & 0xFF] ^ t2[(val >> 16) & 0xFF] ^ t1[(val >> 8) & 0xFF] ^ t0[val & 0xFF]
+
+    # 4 bytes per loop as big-endian 32-bit word
+    else:
+        for (val,) in struct.iter_unpack('>I', memoryview(Data)[:num]):
+            val ^= crc << 16
+            crc = t3[val >> 24] ^ t2[(val >> 16) & 0xFF] ^ t1[(val >> 8) & 0xFF] ^ t0[val & 0xFF]
+
+    # remaining bytes
+    for byte in Data[num:]:
+        crc = ((crc << 8) & 0xFFFF) ^ t0[(crc >> 8) ^ byte]
+
+    # finalize checksum
+    return crc ^ XorOut
+
+
+def calculate_crc32_slicing(Data:bytearray=None, Poly:int=0x04C11DB7, Init:int=0xFFFFFFFF, XorOut:int=0xFFFFFFFF, Slices:int=8) -> int:
+    """
+    Calculate CRC32 checksum (input and output reflected) via slicing-by-4 or slicing-by-8.
+    Default parameters are for CRC32 in https://crccalc.com/
+
+    Args:
+        Data (bytearray): byte array to calculate checksum over
+        Poly (int): used polynom (0x0-0xFFFFFFFF), not reflected
+        Init (int): inital value (0x0-0xFFFFFFFF)
+        XorOut (int): final xor value (0x0-0xFFFFFFFF)
+        Slices (int): bytes per loop (4 or 8)
+
+    Returns:
+        int: calculated CRC32 checksum.
+    """
+
+    # parameter check
+    if not isinstance(Data, (bytes, bytearray)):
+        raise TypeError("Data must be of type bytes or bytearray.")
+    if Slices not in (4, 8):
+        raise ValueError("Slices must be 4 or 8.")
+
+    # get tables, calculate on first call
+    lut = __SLICING_LUT.get((32, Poly, Slices))
+    if lut is None:
+        lut = __generate_crc32_slicing_lut(Poly, Slices)
+        __SLICING_LUT[(32, Poly, Slices)] = lut
+    t0, t1, t2, t3 = lut[0], lut[1], lut[2], lut[3]
+
+    # init checksum. Reflected register
+    crc = reflect(Init, 32)
+    num = len(Data) - len(Data) % Slices
+
+    # 8 bytes per loop as little-endian 64-bit word. CRC is XORed to first 4 bytes
+    if Slices == 8:
+        t4, t5, t6, t7 = lut[4], lut[5], lut[6], lut[7]
+        for (val,) in struct.iter_unpack('<Q', memoryview(Data)[:num]):
+            val ^= crc
+            crc = t7[val & 0xFF] ^ t6[(val >> 8) & 0xFF] ^ t5[(val >> 16) & 0xFF] ^ t4[(val >> 24) & 0xFF] ^ \
+                  t3[(val >> 32) & 0xFF] ^ t2[(val >> 40) & 0xFF] ^ t1[(val >> 48) & 0xFF] ^ t0[val >> 56]
+
+    # 4 bytes per loop as little-endian 32-bit word
+    else:
+        for (val,) in struct.iter_unpack('<I', memoryview(Data)[:num]):
+            val ^= crc
+            crc = t3[val & 0xFF] ^ t2[(val >> 8) & 0xFF] ^ t1[(val >> 16) & 0xFF] ^ t0[val >> 24]
+
+    # remaining bytes
+    for byte in Data[num:]:
+        crc = (crc >> 8) ^ t0[(crc ^ byte) & 0xFF]
+
+    # finalize checksum. XorOut is given for not reflected CRC like in crc_lut.py
+    return crc ^ reflect(XorOut, 32)
+
+
+def __gf2_mulmod(A:int, B:int, Poly:int, Width:int) -> int:
+    """ multiply polynoms A*B modulo (x^Width + Poly) over GF(2) """
+
+    # carry-less multiplication
+    prod = 0
+    while B:
+        if B & 1:
+            prod ^= A
+        A <<= 1
+        B >>= 1
+
+    # reduce bitwise
+    full = (1 << Width) | Poly
+    for i in range(prod.bit_length() - 1, Width - 1, -1):
+        if (prod >> i) & 1:
+            prod ^= full << (i - Width)
+
+    return prod
+
+
+def __gf2_mod(Value:int, Poly:int, Width:int) -> int:
+    """
+    Reduce long polynom modulo (x^Width + Poly) over GF(2) by folding. Is used by calculate_crc_fold()
+
+    Value = H*x^k + L with k=2^m is replaced by L + H*(x^k mod poly), which has about half the bits.
+    Multiplication with x^k mod poly (Width bits) requires max. Width shifts of H, which are done in C.
+    """
+
+    full = (1 << Width) | Poly
+
+    # fold until value is small
+    while Value.bit_length() > 4 * Width:
+
+        # split at largest power of 2 below bit length
+        m = (Value.bit_length() - 1).bit_length() - 1
+        k = 1 << m
+        high = Value >> k
+        Value &= (1 << k) - 1
+
+        # get x^k mod poly via repeated squaring, calculate on first use
+        power = __FOLD_POWER.get((Poly, Width, m))
+        if power is None:
+            power = 1 << 1
+            for _ in range(m):
+                power = __gf2_mulmod(power, power, Poly, Width)
+            __FOLD_POWER[(Poly, Width, m)] = power
+
+        # add H*(x^k mod poly)
+        shift = 0
+        while power >> shift:
+            if (power >> shift) & 1:
+                Value ^= high << shift
+            shift += 1
+
+    # reduce remaining bits bitwise
+    for i in range(Value.bit_length() - 1, Width - 1, -1):
+        if (Value >> i) & 1:
+            Value ^= full << (i - Width)
+
+    return Value
+
+
+def calculate_crc_fold(Data:bytearray=None, Width:int=32, Poly:int=0x04C11DB7, Init:int=0xFFFFFFFF, RefIn:bool=True, RefOut:bool=True, XorOut:int=0xFFFFFFFF) -> int:
+    """
+    Calculate CRC checksum for the given byte array via long integer folding, i.e. w/o Python loop over data.
+    CRC = (Init*x^(8*len) + Data*x^Width) mod poly.
+    Default parameters are for CRC32 in https://crccalc.com/
+
+    Args:
+        Data (bytearray): byte array to calculate checksum over
+        Width (int): CRC width in bits (8, 16, 32)
+        Poly (int): used polynom, not reflected
+        Init (int): inital value
+        RefIn (bool): reverse input bits
+        RefOut (bool): reverse output bits
+        XorOut (int): final xor value
+
+    Returns:
+        int: calculated CRC checksum.
+    """
+
+    # parameter type check
+    if not isinstance(Data, (bytes, bytearray)):
+        raise TypeError("Data must be of type bytes or bytearray.")
+
+    # reverse input bits via translate() (in C)
+    if RefIn:
+        Data = Data.translate(__REVERSE_BITS)
+
+    # data as polynom multiplied with x^Width, first bit has highest power. Add init value
+    value = int.from_bytes(Data, 'big') << Width
+    value ^= Init << (8 * len(Data))
+
+    # polynom division
+    crc = __gf2_mod(value, Poly, Width)
+
+    # finalize checksum
+    crc ^= XorOut
+    if RefOut:
+        crc = reflect(crc, Width)
+
+    return crc
+
+
+def calculate_crc16_fold(Data:bytearray=None) -> int:
+    """ Calculate CRC16-CCITT-FALSE via long integer folding, see calculate_crc_fold() """
+    return calculate_crc_fold(Data, Width=16, Poly=0x1021, Init=0xFFFF, RefIn=False, RefOut=False, XorOut=0x0000)
+
+
+def calculate_crc32_fold(Data:bytearray=None) -> int:
+    """ Calculate CRC32 via long integer folding, see calculate_crc_fold() """
+    return calculate_crc_fold(Data, Width=32, Poly=0x04C11DB7, Init=0xFFFFFFFF, RefIn=True, RefOut=True, XorOut=0xFFFFFFFF)
+
+
+
+if __name__ == "__main__":
+
+    import random
+    import crc_lut
+
+    # Example usage
+    random.seed(42); data = bytearray([random.randint(0, 255) for _ in range(100)])
+
+    # calculate checksums
+    print("input:", end=" ")
+    print(''.join(['{:02X}'.format(byte) for byte in data]))
+    print(f"CRC16/CCITT-FALSE: 0x{crc_lut.calculate_crc16(Data=data):04X} (LUT)")
+    print(f"CRC16/CCITT-FALSE: 0x{calculate_crc16_slicing(Data=data, Slices=4):04X} (slicing-by-4)")
+    print(f"CRC16/CCITT-FALSE: 0x{calculate_crc16_slicing(Data=data, Slices=8):04X} (slicing-by-8)")
+    print(f"CRC16/CCITT-FALSE: 0x{calculate_crc16_fold(Data=data):04X} (folding)")
+    print(f"CRC32: 0x{crc_lut.calculate_crc32(Data=data):08X} (LUT)")
+    print(f"CRC32: 0x{calculate_crc32_slicing(Data=data, Slices=4):08X} (slicing-by-4)")
+    print(f"CRC32: 0x{calculate_crc32_slicing(Data=data, Slices=8):08X} (slicing-by-8)")
+    print(f"CRC32: 0x{calculate_crc32_fold(Data=data):08X} (folding)")
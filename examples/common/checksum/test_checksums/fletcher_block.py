@@ -0,0 +1,138 @@
+# -*- coding: utf-8 -*-
+"""
+Check deferred-modulo Fletcher-16 block kernel of checksum_fletcher16.c
+
+Emulates fletcher16_chk_block() / fletcher16_chk_range() with 16-bit sums,
+which are reduced modulo 255 only every FLETCHER16_BLOCK_MAX bytes. Results
+are compared against fletcher.py for random data and random ranges.
+Any 16-bit overflow of the emulated sums is reported as error.
+The same random ranges are checked with the compiled C routines
+fletcher16_chk_block() and fletcher16_chk_range() via the host build
+(see host_lib.py). Exits with 1 on any error, e.g. for "make test" in ../../host.
+
+@author: gicking @ Github
+"""
+
+import sys
+import fletcher
+import host_lib
+
+
+# max. number of bytes between modulo reductions (see checksum_fletcher16.h)
+FLETCHER16_BLOCK_MAX = 21
+
+
+def max_block_size(Width:int=16) -> int:
+    """
+    Calculate max. number of bytes between modulo reductions w/o overflow.
+    Worst case is sum1=sum2=255 at block start and all data bytes =255.
+
+    Args:
+        Width (int): width of sum variables [bit]
+
+    Returns:
+        int: max. number of bytes between modulo reductions.
+    """
+
+    n = 0
+    while (255 + 255*(n+1) + 255*(n+1)*(n+2)//2) < (1 << Width):
+        n += 1
+    return n
+
+
+def calculate_fletcher16_block(Data:bytearray=None, Chk:int=0x0000, Block:int=FLETCHER16_BLOCK_MAX) -> int:
+    """
+    Calculate Fletcher-16 checksum like fletcher16_chk_block() in checksum_fletcher16.c
+
+    Args:
+        Data (bytearray): byte array to calculate checksum over
+        Chk (int): previous checksum value
+        Block (int): number of bytes between modulo reductions
+
+    Returns:
+        int: calculated Fletcher-16 checksum.
+    """
+
+    # get individual checksums
+    sum1 = Chk & 0xFF
+    sum2 = (Chk >> 8) & 0xFF
+
+    # loop over blocks
+    for start in range(0, len(Data), Block):
+
+        # update sums w/o modulo. Check for 16-bit overflow
+        for val in Data[start:start+Block]:
+            sum1 += val
+            sum2 += sum1
+            if (sum1 > 0xFFFF) or (sum2 > 0xFFFF):
+                raise OverflowError("16-bit overflow for block size %d" % Block)
+
+        # reduce sums
+        sum1 %= 255
+        sum2 %= 255
+
+    # return combined result
+    return (sum2 << 8) | sum1
+
+
+
+if __name__ == '__main__':
+
+    import random
+
+    # set parameters
+    num_iterations = 10000        # number of random ranges to check
+    image_size = 65536            # size of random memory image [B]
+    image_addr = 0x8000           # address of image in simulated memory of C code (across 64kB bank boundary)
+
+    # check max. block size vs. checksum_fletcher16.h
+    errors = 0
+    print("max. block size (16-bit sums): %d (used %d)" % (max_block_size(16), FLETCHER16_BLOCK_MAX))
+    print("max. block size (32-bit sums): %d" % max_block_size(32))
+    if max_block_size(16) != FLETCHER16_BLOCK_MAX:
+        errors += 1
+
+    # worst case: max. start sums and all bytes 0xFF must not overflow with FLETCHER16_BLOCK_MAX, but with FLETCHER16_BLOCK_MAX+1
+    data = bytearray([0xFF] * 1000)
+    calculate_fletcher16_block(data, Chk=0xFEFE)
+    try:
+        calculate_fletcher16_block(data, Chk=0xFEFE, Block=FLETCHER16_BLOCK_MAX+1)
+        print("block size %d: no overflow -> FLETCHER16_BLOCK_MAX not maximal" % (FLETCHER16_BLOCK_MAX+1))
+        errors += 1
+    except OverflowError:
+        pass
+
+    # C code via host build
+    lib = host_lib.load_host_lib()
+
+    # fuzz random ranges of random memory image. Include worst-case image with all 0xFF.
+    # Range lengths are random, i.e. mostly no multiple of FLETCHER16_BLOCK_MAX
+    random.seed(42)
+    errors_c = 0
+    for image in (bytearray(random.getrandbits(8) for _ in range(image_size)), bytearray([0xFF] * image_size)):
+        host_lib.write_memory(lib, image_addr, image)
+        for i in range(num_iterations):
+            start = random.randint(0, image_size-1)
+            end = random.randint(start, min(start + random.choice((64, 1024, 8192)), image_size-1))
+            data = image[start:end+1]
+            ref = fletcher.calculate_fletcher16(data)
+            if calculate_fletcher16_block(data) != ref:
+                errors += 1
+
+            # split range in two blocks and continue with previous checksum
+            split = random.randint(0, len(data))
+            if calculate_fletcher16_block(data[split:], Chk=calculate_fletcher16_block(data[:split])) != ref:
+                errors += 1
+
+            # C code: range in simulated memory, and split block
+            if lib.fletcher16_chk_range(image_addr+start, image_addr+end) != ref:
+                errors_c += 1
+            if lib.fletcher16_chk_block(lib.fletcher16_chk_block(0x0000, bytes(data[:split]), split), bytes(data[split:]), len(data)-split) != ref:
+                errors_c += 1
+
+    # print result
+    print("%d random ranges: %d errors" % (2*num_iterations, errors))
+    print("%d random ranges (C code): %d errors" % (2*num_iterations, errors_c))
+
+    # return error for automated tests
+    sys.exit(1 if (errors + errors_c) else 0)
@@ -0,0 +1,66 @@
+# -*- coding: utf-8 -*-
+"""
+Access C implementation of checksum routines via host build (see ../../host)
+
+Builds the shared library of the common libraries for the selected
+CRC16_CCITT_IMPL via make, and loads it via ctypes. The simulated
+24-bit memory of the mock "stm8s.h" is available as lib.memory,
+e.g. for crc16_ccitt_range() and fletcher16_chk_range().
+
+@author: gicking @ Github
+"""
+
+import os
+import ctypes
+import subprocess
+
+
+# directory of host build and size of simulated memory (see host/stm8s.h)
+HOST_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "host")
+HOST_MEMORY_SIZE = 0x30000
+
+
+def load_host_lib(Impl:int=0) -> ctypes.CDLL:
+    """
+    Build (if required) and load host library of common routines.
+
+    Args:
+        Impl (int): CRC16 variant, see CRC16_CCITT_IMPL in checksum_crc16.h
+
+    Returns:
+        ctypes.CDLL: library with prototypes of checksum routines and simulated memory.
+    """
+
+    # build library via Makefile of host build
+    name = "libhost_crc%d.so" % Impl
+    subprocess.run(["make", "-s", "-C", HOST_DIR, name], check=True)
+    lib = ctypes.CDLL(os.path.join(HOST_DIR, name))
+
+    # set prototypes of checksum routines
+    for prefix in ("crc16_ccitt", "fletcher16_chk"):
+        getattr(lib, prefix + "_update").argtypes = [ctypes.c_uint16, ctypes.c_uint8]
+        getattr(lib, prefix + "_update").restype = ctypes.c_uint16
+        getattr(lib, prefix + "_block").argtypes = [ctypes.c_uint16, ctypes.c_char_p, ctypes.c_uint16]
+        getattr(lib, prefix + "_block").restype = ctypes.c_uint16
+        getattr(lib, prefix + "_range").argtypes = [ctypes.c_uint32, ctypes.c_uint32]
+        getattr(lib, prefix + "_range").restype = ctypes.c_uint16
+
+    # simulated memory for range routines
+    lib.memory = (ctypes.c_uint8 * HOST_MEMORY_SIZE).in_dll(lib, "g_hostMemory")
+
+    return lib
+
+
+def write_memory(Lib:ctypes.CDLL, Addr:int, Data:bytearray):
+    """
+    Copy data to simulated memory of host library.
+
+    Args:
+        Lib (ctypes.CDLL): library loaded via load_host_lib()
+        Addr (int): start address in simulated memory
+        Data (bytearray): data to copy
+    """
+
+    if (Addr < 0) or (Addr + len(Data) > HOST_MEMORY_SIZE):
+        raise ValueError("address range exceeds simulated memory")
+    ctypes.memmove(ctypes.addressof(Lib.memory) + Addr, bytes(Data), len(Data))
@@ -0,0 +1,149 @@
+# -*- coding: utf-8 -*-
+"""
+Read memory images from Intel hex (*.ihx, *.hex) or binary (*.bin) files, write Intel hex files
+
+Intel hex files support data records (00), end of file (01) and extended segment/linear
+address records (02, 04). Other records are ignored. Gaps are filled with a fill value.
+
+@author: gicking @ Github
+"""
+
+import os
+
+
+def read_ihx(Filename:str) -> dict:
+    """
+    Read data records of Intel hex file.
+
+    Args:
+        Filename (str): name of Intel hex file
+
+    Returns:
+        dict: data bytes as {address: value}
+    """
+
+    data = {}
+    offset = 0
+
+    with open(Filename, 'r') as f:
+        for num, line in enumerate(f, start=1):
+
+            # skip empty lines and lines w/o record start
+            line = line.strip()
+            if not line.startswith(':'):
+                continue
+
+            # convert record to bytes and check length and checksum
+            record = bytes.fromhex(line[1:])
+            if (len(record) < 5) or (len(record) != record[0] + 5):
+                raise ValueError("%s line %d: wrong record length" % (Filename, num))
+            if (sum(record) & 0xFF) != 0:
+                raise ValueError("%s line %d: wrong record checksum" % (Filename, num))
+
+            # get record fields
+            length  = record[0]
+            address = (record[1] << 8) | record[2]
+            rtype   = record[3]
+            payload = record[4:4+length]
+
+            # data record
+            if rtype == 0x00:
+                for i, val in enumerate(payload):
+                    data[offset + address + i] = val
+
+            # end of file record
+            elif rtype == 0x01:
+                break
+
+            # extended segment address record (address bits 4..19)
+            elif rtype == 0x02:
+                offset = ((payload[0] << 8) | payload[1]) << 4
+
+            # extended linear address record (address bits 16..31)
+            elif rtype == 0x04:
+                offset = ((payload[0] << 8) | payload[1]) << 16
+
+    return data
+
+
+def write_ihx(Filename:str, Data:dict, Record_size:int=16):
+    """
+    Write data to Intel hex file. Addresses >64kB use extended linear address records (04).
+
+    Args:
+        Filename (str): name of Intel hex file
+        Data (dict): data bytes as {address: value}
+        Record_size (int): max. number of bytes per data record
+    """
+
+    # convert record to line incl. checksum
+    def record(Address, Type, Payload):
+        rec = bytes([len(Payload), (Address >> 8) & 0xFF, Address & 0xFF, Type]) + bytes(Payload)
+        return ':' + (rec + bytes([(-sum(rec)) & 0xFF])).hex().upper() + '\n'
+
+    lines = []
+    upper = 0
+    addresses = sorted(Data)
+    i = 0
+    while i < len(addresses):
+
+        # new upper 16 address bits -> extended linear address record
+        start = addresses[i]
+        if (start >> 16) != upper:
+            upper = start >> 16
+            lines.append(record(0, 0x04, [upper >> 8, upper & 0xFF]))
+
+        # collect consecutive bytes within same 64kB segment
+        payload = [Data[start]]
+        i += 1
+        while (i < len(addresses)) and (len(payload) < Record_size) and (addresses[i] == start + len(payload)) and ((addresses[i] >> 16) == upper):
+            payload.append(Data[addresses[i]])
+            i += 1
+        lines.append(record(start & 0xFFFF, 0x00, payload))
+
+    # end of file record
+    lines.append(record(0, 0x01, []))
+
+    with open(Filename, 'w') as f:
+        f.writelines(lines)
+
+
+def read_image(Filename:str, Start:int=None, End:int=None, Fill:int=0x00, Offset:int=0x8000) -> bytearray:
+    """
+    Read memory image from Intel hex or binary file.
+
+    Args:
+        Filename (str): name of *.ihx, *.hex or *.bin file
+        Start (int): first address of image (default: lowest address in file)
+        End (int): last address of image (default: highest address in file)
+        Fill (int): value for addresses w/o data (STM8 erased flash: 0x00)
+        Offset (int): address of first byte of binary file (default: STM8 flash start)
+
+    Returns:
+        bytearray: memory content from Start..End
+    """
+
+    # read file into {address: value}
+    if os.path.splitext(Filename)[1].lower() in ('.ihx', '.hex'):
+        data = read_ihx(Filename)
+    else:
+        with open(Filename, 'rb') as f:
+            data = {Offset + i: val for i, val in enumerate(f.read())}
+    if len(data) == 0:
+        raise ValueError("%s contains no data" % Filename)
+
+    # default address range from file content
+    if Start is None:
+        Start = min(data)
+    if End is None:
+        End = max(data)
+    if End < Start:
+        raise ValueError("end address 0x%x below start address 0x%x" % (End, Start))
+
+    # copy data to image, fill gaps
+    image = bytearray([Fill] * (End - Start + 1))
+    for address, val in data.items():
+        if Start <= address <= End:
+            image[address - Start] = val
+
+    return image
@@ -12,6 +12,16 @@ Results for data_size=1024. For CRC compare with https://quickbirdstudios.com/bl
 
 Test-System: Intel Core i5 @ 2.6GHz; Windows 10 Enterprise
 
+Above runtimes are for reference routines in crc_lut.py and fletcher.py. Now checksums are
+calculated with equivalent fast routines (see fast_checksum()), random data is fetched in batches
+and iterations are distributed to all CPU cores. Runtime per core for data_size=1024 (Linux, Python 3.11):
+  - CRC8: 1E6 cycles / 32s
+  - CRC16: 1E7 cycles / 1m21s
+  - CRC32: 1E8 cycles / 6m22s
+  - Fletcher-16: 1E7 cycles / 2m20s
+  - Fletcher-32, -64: 1E7 cycles / 3m50s
+Fast routines are checked vs. reference routines before each measurement.
+
 @author: gicking @ Github
 """
 
@@ -19,16 +29,155 @@ Test-System: Intel Core i5 @ 2.6GHz; Windows 10 Enterprise
 import crc_lut
 import fletcher
 import os
+import sys
+import zlib
+import binascii
+import multiprocessing
 
 
-# collision measurement
-def measure_collision_rate(data_size, num_iterations, method=None):
-    
-    collisions = 0
-    print_period = num_iterations/50
-    print_space  = print_period*5
-    
-    # store pointer to checksum routine
+# number of random arrays fetched with a single os.urandom() call
+BATCH_SIZE = 256
+
+# CRC8 table for 2 bytes per step (poly 0x07), see __generate_crc8_lut16()
+__CRC8_LUT16 = None
+
+
+def __generate_crc8_lut16():
+    """
+    Calculate CRC8 lookup table for 16-bit words in native byte order, i.e. 2 bytes per LUT access.
+    Index is word XOR current CRC at position of 1st byte in memory.
+
+    Returns:
+        list: The CRC8 lookup table with 65536 entries.
+    """
+
+    # 8-bit LUT of reference (0x07, no reflection), via CRC of single byte
+    lut8 = [crc_lut.calculate_crc8(bytes([i])) for i in range(256)]
+
+    # combine 2 steps: crc = lut8[lut8[crc ^ b0] ^ b1]
+    lut16 = [0] * 65536
+    for b0 in range(256):
+        for b1 in range(256):
+            if sys.byteorder == 'little':
+                lut16[b0 | (b1 << 8)] = lut8[lut8[b0] ^ b1]
+            else:
+                lut16[(b0 << 8) | b1] = lut8[lut8[b0] ^ b1]
+
+    return lut16
+
+
+def __fletcher_sums(Data, Bytes):
+    """
+    Calculate Fletcher sums in closed form, i.e. w/o loop in Python.
+    Words are in native byte order and have base B=2^(8*Bytes), modulo is M=B-1. As B = 1+M,
+    B^i = 1 + i*M (mod M^2) and data as long integer X = sum(w_i * B^i) = S + W*M (mod M^2),
+    with S = sum(w_i) and W = sum(i * w_i). With sum2 = sum(w_i * (n-i)) = n*S - W.
+
+    Args:
+        Data (bytes): data with length multiple of Bytes
+        Bytes (int): word size [B] (1, 2, 4)
+
+    Returns:
+        int: sum1 and sum2 of Fletcher checksum
+    """
+
+    M = (1 << (8 * Bytes)) - 1
+    n = len(Data) // Bytes
+
+    # exact sum of words
+    if Bytes == 1:
+        S = sum(Data)
+    else:
+        S = sum(memoryview(Data).cast('H' if Bytes == 2 else 'I'))
+
+    # weighted sum of words via long integer. For big endian 1st word has highest weight
+    X = int.from_bytes(Data, sys.byteorder) % (M * M)
+    W = ((X - S) % (M * M)) // M
+    if sys.byteorder == 'little':
+        sum2 = (n * S - W) % M
+    else:
+        sum2 = (S + W) % M
+
+    return S % M, sum2
+
+
+def fast_checksum(Data, method):
+    """
+    Calculate checksum with same result as reference routines in crc_lut.py and fletcher.py, but faster:
+      - CRC16 and CRC32 via C routines of binascii and zlib (same polynom and parameters)
+      - CRC8 via 16-bit LUT, i.e. 2 bytes per loop
+      - Fletcher via sum of words and long integer modulo, see __fletcher_sums()
+
+    Args:
+        Data (bytes): byte array to calculate checksum over. Is not modified (no padding in place)
+        method (str): checksum method: crc8, crc16, crc32, fletcher16, fletcher32, fletcher64
+
+    Returns:
+        int: calculated checksum.
+    """
+
+    global __CRC8_LUT16
+
+    method = method.upper()
+
+    # CRC16-CCITT-FALSE: poly 0x1021, init 0xFFFF, no reflection
+    if method == "CRC16":
+        return binascii.crc_hqx(Data, 0xFFFF)
+
+    # CRC32: poly 0x04C11DB7, init 0xFFFFFFFF, reflected, xor 0xFFFFFFFF
+    elif method == "CRC32":
+        return zlib.crc32(Data)
+
+    # CRC8: poly 0x07, init 0x00, no reflection
+    elif method == "CRC8":
+        if __CRC8_LUT16 is None:
+            __CRC8_LUT16 = __generate_crc8_lut16()
+        lut = __CRC8_LUT16
+        crc = 0
+        if sys.byteorder == 'little':
+            for word in memoryview(Data[:len(Data) & ~1]).cast('H'):
+                crc = lut[crc ^ word]
+        else:
+            for word in memoryview(Data[:len(Data) & ~1]).cast('H'):
+                crc = lut[(crc << 8) ^ word]
+        if len(Data) & 1:
+            crc = crc_lut.calculate_crc8(bytes([crc ^ Data[-1]]))
+        return crc
+
+    # Fletcher-16: 8-bit words, mod 0xFF
+    elif method == "FLETCHER16":
+        sum1, sum2 = __fletcher_sums(Data, 1)
+        return (sum2 << 8) | sum1
+
+    # Fletcher-32: 16-bit words in native byte order, mod 0xFFFF. Pad with 0
+    elif method == "FLETCHER32":
+        if len(Data) % 2:
+            Data = bytes(Data) + bytes(2 - len(Data) % 2)
+        sum1, sum2 = __fletcher_sums(Data, 2)
+        return (sum2 << 16) | sum1
+
+    # Fletcher-64: 32-bit words in native byte order, mod 0xFFFFFFFF. Pad with 0
+    elif method == "FLETCHER64":
+        if len(Data) % 4:
+            Data = bytes(Data) + bytes(4 - len(Data) % 4)
+        sum1, sum2 = __fletcher_sums(Data, 4)
+        return (sum2 << 32) | sum1
+
+    else:
+        raise TypeError("Illegal parameter method: '" + str(method) + "'")
+
+
+def check_fast_checksum(method, data_size):
+    """
+    Compare fast_checksum() with reference routines in crc_lut.py and fletcher.py for random data.
+    Raise exception on deviation.
+
+    Args:
+        method (str): checksum method: crc8, crc16, crc32, fletcher16, fletcher32, fletcher64
+        data_size (int): size of main test data [B]. Additionally odd sizes are checked
+    """
+
+    # store pointer to reference checksum routine
     if method.upper() == "CRC8":
         fct_checksum = crc_lut.calculate_crc8
     elif method.upper() == "CRC16":
@@ -44,34 +193,84 @@ def measure_collision_rate(data_size, num_iterations, method=None):
     else:
         raise TypeError("Illegal parameter method: '" + str(method) + "'")
 
-    # initialize first data set    
-    data1 = bytearray(os.urandom(data_size))
-    checksum1 = fct_checksum(data1)
-
-    # loop over cycles. Don't use range() due to large num_iterations
-    i = 0
-    while i < int(num_iterations):
-        
-        # get new random array and calculate checksum
-        data2 = bytearray(os.urandom(data_size))
-        checksum2 = fct_checksum(data2)
-        
-        # if checksums match, increase error counter
-        if checksum2 == checksum1:
-            collisions += 1
-
-        # make new data to old for next loop
-        data1[:] = data2
-        checksum1 = checksum2
-        
-        # increase cycle counter
-        i += 1
-        
-        # print progress
-        if i % print_period == 0:
+    # compare for random data of different sizes. Include worst case of all 0xFF
+    for size in [data_size, 1, 2, 3, 5, 6, 7, 255]:
+        for data in [os.urandom(size), bytes([0xFF] * size)]:
+            reference = fct_checksum(bytearray(data))
+            fast = fast_checksum(data, method)
+            if fast != reference:
+                raise ValueError("fast %s 0x%X differs from reference 0x%X for size %d" % (method, fast, reference, size))
+
+
+def __count_collisions(data_size, num_iterations, method):
+    """
+    Count collisions of consecutive random arrays. Is executed in parallel by worker processes
+
+    Args:
+        data_size (int): data size [B]
+        num_iterations (int): number of arrays to check for collisions
+        method (str): checksum method
+
+    Returns:
+        int: number of collisions
+    """
+
+    collisions = 0
+
+    # initialize first data set
+    checksum1 = fast_checksum(os.urandom(data_size), method)
+
+    # loop over batches of random arrays
+    remaining = num_iterations
+    while remaining > 0:
+
+        # get random data for multiple arrays with single call
+        num = min(remaining, BATCH_SIZE)
+        batch = os.urandom(num * data_size)
+
+        # calculate checksums. If consecutive checksums match, increase error counter
+        for start in range(0, num * data_size, data_size):
+            checksum2 = fast_checksum(batch[start:start+data_size], method)
+            if checksum2 == checksum1:
+                collisions += 1
+            checksum1 = checksum2
+
+        remaining -= num
+
+    # return number of collisions
+    return collisions
+
+
+def __count_collisions_task(args):
+    """ wrapper for Pool.imap_unordered(), which passes a single argument """
+    return __count_collisions(*args)
+
+
+# collision measurement
+def measure_collision_rate(data_size, num_iterations, method=None, num_processes=None):
+
+    collisions = 0
+    num_iterations = int(num_iterations)
+
+    # check fast routine vs. reference once. Also checks method
+    check_fast_checksum(method, data_size)
+
+    # split iterations in 50 tasks for progress indicator ('.' per task, ' ' every 5 tasks)
+    num_tasks = 50
+    tasks = []
+    for i in range(num_tasks):
+        iterations = num_iterations // num_tasks + (1 if i < num_iterations % num_tasks else 0)
+        tasks.append((data_size, iterations, method))
+
+    # distribute tasks to all CPU cores (default) and print progress
+    if num_processes is None:
+        num_processes = os.cpu_count() or 1
+    with multiprocessing.Pool(processes=num_processes) as pool:
+        for i, result in enumerate(pool.imap_unordered(__count_collisions_task, tasks)):
+            collisions += result
             print(".", end="", flush=True)
-        if i % print_space == 0:
-            print(" ", end="", flush=True)
+            if (i + 1) % 5 == 0:
+                print(" ", end="", flush=True)
 
     # calculate collision rate [ppm]
     collision_rate = collisions / num_iterations * 1000000
@@ -81,20 +280,21 @@ def measure_collision_rate(data_size, num_iterations, method=None):
 
 
 if __name__ == '__main__':
-    
+
     import time
 
     # set parameters
     data_size = 1024            # data size [B]
-    num_iterations = 1E7        # number of arrays to check for collisions
-    method = "fletcher64"            # checksum method: crc8, crc16, crc32, fletcher16, fletcher32, fletcher64
-    
+    num_iterations = 1E8        # number of arrays to check for collisions
+    method = "crc32"            # checksum method: crc8, crc16, crc32, fletcher16, fletcher32, fletcher64
+    num_processes = None        # number of parallel processes (None = number of CPU cores)
+
     # measure checksum collision rates
     print("Start %g cycles %s " % (num_iterations, method), end="", flush=True)
     timeStart = time.time()
-    collision_rate = measure_collision_rate(data_size, num_iterations, method=method)
+    collision_rate = measure_collision_rate(data_size, num_iterations, method=method, num_processes=num_processes)
     timeEnd = time.time()
     print(" done after %ds\n" % (timeEnd-timeStart))
-    
+
     # print result [ppm]
     print("Collision rate: %.2gppm" % (collision_rate))
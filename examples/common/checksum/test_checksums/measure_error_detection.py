@@ -0,0 +1,432 @@
+# -*- coding: utf-8 -*-
+"""
+Measure rate of undetected errors (=same checksum after bit errors) for flash corruption patterns
+
+Unlike measure_collision.py, which compares independent random arrays, a fixed base image (e.g.
+real firmware *.ihx or *.bin) is corrupted by bit errors, and it is checked if the checksum changes.
+Error patterns are configured as:
+  - bits:K     K bit flips at random positions, e.g. bits:1, bits:2
+  - burst:L    burst of length L bits at random position, i.e. first and last bit flipped, bits in
+               between random. Bits are counted like in a hexdump, i.e. ascending addresses, MSB first
+
+Checksums are not recalculated over the full image per pattern, but only the effect of the flipped bits:
+  - CRC is linear, i.e. CRC(image ^ error) == CRC(image) if error polynom is divisible by CRC polynom.
+    This is checked by XOR of precalculated x^k mod poly per flipped bit ('syndrome')
+  - Fletcher sums change by the word deltas (+/- 2^bit, depends on image) times 1 (sum1) and n-i (sum2).
+    Error is undetected if both changes are divisible by the modulus
+Engine is checked vs. full checksum calculation of measure_collision.fast_checksum() before each run.
+
+Usage examples:
+  python measure_error_detection.py -s 1024 -n 1e6
+  python measure_error_detection.py -i firmware.ihx -p bits:2 -p burst:17 -m crc16 -m fletcher16
+
+@author: gicking @ Github
+"""
+
+import measure_collision
+import image_file
+import os
+import sys
+import random
+import argparse
+import multiprocessing
+
+
+# supported checksums with parameters of crc_lut.py and fletcher.py. CRC: (width, polynom, reflected input)
+CRC_PARAMETERS = {
+    "CRC8":  (8,  0x07,       False),
+    "CRC16": (16, 0x1021,     False),
+    "CRC32": (32, 0x04C11DB7, True)
+}
+
+# Fletcher: word size [B]
+FLETCHER_PARAMETERS = {
+    "FLETCHER16": 1,
+    "FLETCHER32": 2,
+    "FLETCHER64": 4
+}
+
+# default checksums and error patterns
+METHODS  = ["crc8", "crc16", "crc32", "fletcher16", "fletcher32", "fletcher64"]
+PATTERNS = ["bits:1", "bits:2", "bits:3", "bits:4", "burst:8", "burst:16", "burst:17", "burst:32", "burst:33"]
+
+# worker context, see __init_worker()
+__CONTEXT = None
+
+
+def crc_syndrome_table(Image_size:int, Width:int, Poly:int, RefIn:bool) -> list:
+    """
+    Calculate CRC syndromes for single bit errors, i.e. x^k mod poly with k = distance to end of data.
+    Init and final XOR values of CRC cancel out and are not required.
+
+    Args:
+        Image_size (int): image size [B]
+        Width (int): CRC width (8, 16, 32)
+        Poly (int): CRC polynom w/o leading 1
+        RefIn (bool): input bytes are reflected (LSB first)
+
+    Returns:
+        list: syndrome for each bit of image. Index is address*8 + 7-bit
+    """
+
+    num_bits = 8 * Image_size
+
+    # x^k mod poly for k=0..num_bits-1
+    power = [0] * num_bits
+    val = 1
+    for k in range(num_bits):
+        power[k] = val
+        val <<= 1
+        if val >> Width:
+            val ^= (1 << Width) | Poly
+
+    # sort by image bit. Without reflection MSB of each byte is processed first, i.e. has highest power
+    table = [0] * num_bits
+    for j in range(num_bits):
+        byte = j // 8
+        bit = 7 - j % 8
+        if RefIn:
+            bit = 7 - bit
+        table[j] = power[(Image_size - 1 - byte) * 8 + bit]
+
+    return table
+
+
+def crc_undetected_pattern(Image_size:int, Width:int, Poly:int, RefIn:bool, Shift:int) -> list:
+    """
+    Get bit errors which cannot be detected by CRC, i.e. error polynom = poly * x^Shift.
+    Is used for checking the engine
+
+    Args:
+        Image_size (int): image size [B]
+        Width (int): CRC width (8, 16, 32)
+        Poly (int): CRC polynom w/o leading 1
+        RefIn (bool): input bytes are reflected (LSB first)
+        Shift (int): position of error (0..8*Image_size-Width-1)
+
+    Returns:
+        list: flipped bits. Index is address*8 + 7-bit
+    """
+
+    flips = []
+    full = (1 << Width) | Poly
+    for exp in range(Width + 1):
+        if full & (1 << exp):
+            k = exp + Shift
+            byte = Image_size - 1 - k // 8
+            bit = k % 8
+            if not RefIn:
+                bit = 7 - bit
+            flips.append(byte * 8 + bit)
+
+    return flips
+
+
+def get_error_pattern(Pattern:str, Num_bits:int, Rand:random.Random) -> list:
+    """
+    Get random error pattern
+
+    Args:
+        Pattern (str): pattern type, e.g. 'bits:2' or 'burst:17'
+        Num_bits (int): number of bits in image
+        Rand (random.Random): random generator
+
+    Returns:
+        list: flipped bits. Index is address*8 + 7-bit
+    """
+
+    kind, length = Pattern.lower().split(':')
+    length = int(length)
+
+    # K bit flips at different random positions
+    if kind == 'bits':
+        return Rand.sample(range(Num_bits), length)
+
+    # burst of length L: first and last bit flipped, random in between
+    elif kind == 'burst':
+        start = Rand.randrange(Num_bits - length + 1)
+        if length == 1:
+            return [start]
+        inner = Rand.getrandbits(length - 2) if length > 2 else 0
+        flips = [start]
+        for i in range(length - 2):
+            if (inner >> i) & 1:
+                flips.append(start + 1 + i)
+        flips.append(start + length - 1)
+        return flips
+
+    else:
+        raise ValueError("Illegal error pattern: '" + str(Pattern) + "'")
+
+
+def check_pattern(Pattern:str, Image_size:int):
+    """
+    Check error pattern and image size. Raise exception on error
+
+    Args:
+        Pattern (str): pattern type, e.g. 'bits:2' or 'burst:17'
+        Image_size (int): image size [B]
+    """
+
+    try:
+        kind, length = Pattern.lower().split(':')
+        length = int(length)
+    except ValueError:
+        raise ValueError("Illegal error pattern: '" + str(Pattern) + "' (use bits:K or burst:L)")
+    if (kind not in ('bits', 'burst')) or (length < 1) or (length > 8 * Image_size):
+        raise ValueError("Illegal error pattern: '" + str(Pattern) + "' for %dB image" % Image_size)
+
+
+class ErrorDetection:
+    """
+    Check if errors are detected by checksums for a fixed image
+    """
+
+    def __init__(self, Image:bytes, Methods:list):
+        """
+        Precalculate CRC syndromes and Fletcher words for image
+
+        Args:
+            Image (bytes): base image
+            Methods (list): checksum methods, e.g. ['crc16', 'fletcher16']
+        """
+
+        self.image = bytes(Image)
+        self.num_bits = 8 * len(self.image)
+        self.methods = [method.upper() for method in Methods]
+
+        self.crc_tables = {}
+        self.fletcher_words = {}
+        for method in self.methods:
+
+            # CRC: syndrome per image bit
+            if method in CRC_PARAMETERS:
+                width, poly, refin = CRC_PARAMETERS[method]
+                self.crc_tables[method] = crc_syndrome_table(len(self.image), width, poly, refin)
+
+            # Fletcher: image words in native byte order like fletcher.py. Pad with 0
+            elif method in FLETCHER_PARAMETERS:
+                size = FLETCHER_PARAMETERS[method]
+                data = self.image + bytes((size - len(self.image) % size) % size)
+                if size == 1:
+                    self.fletcher_words[method] = list(data)
+                else:
+                    self.fletcher_words[method] = list(memoryview(data).cast('H' if size == 2 else 'I'))
+
+            else:
+                raise TypeError("Illegal parameter method: '" + str(method) + "'")
+
+
+    def undetected(self, Method:str, Flips:list) -> bool:
+        """
+        Check if bit errors are undetected, i.e. checksum is unchanged
+
+        Args:
+            Method (str): checksum method (upper case)
+            Flips (list): flipped bits. Index is address*8 + 7-bit. Bits must be different
+
+        Returns:
+            bool: True if error is not detected
+        """
+
+        # CRC: XOR of syndromes is zero
+        table = self.crc_tables.get(Method)
+        if table is not None:
+            syndrome = 0
+            for j in Flips:
+                syndrome ^= table[j]
+            return syndrome == 0
+
+        # Fletcher: combine flips per word
+        size = FLETCHER_PARAMETERS[Method]
+        words = self.fletcher_words[Method]
+        masks = {}
+        for j in Flips:
+            byte = j // 8
+            bit = 7 - j % 8
+            index, pos = divmod(byte, size)
+            if sys.byteorder != 'little':
+                pos = size - 1 - pos
+            masks[index] = masks.get(index, 0) ^ (1 << (8 * pos + bit))
+
+        # change of sums, i.e. word deltas weighted with 1 and n-i
+        n = len(words)
+        delta1 = 0
+        delta2 = 0
+        for index, mask in masks.items():
+            delta = (words[index] ^ mask) - words[index]
+            delta1 += delta
+            delta2 += (n - index) * delta
+        modulus = (1 << (8 * size)) - 1
+        return (delta1 % modulus == 0) and (delta2 % modulus == 0)
+
+
+def check_engine(Num_patterns:int=2000, Seed:int=0):
+    """
+    Compare ErrorDetection vs. full checksum calculation for small random images. Include errors
+    which cannot be detected by CRC and 0x00<->0xFF errors, which cannot be detected by Fletcher.
+    Raise exception on deviation.
+
+    Args:
+        Num_patterns (int): number of random patterns per method
+        Seed (int): seed of random generator
+    """
+
+    rand = random.Random(Seed)
+
+    # odd image size to check padding, some 0x00 for Fletcher 0x00->0xFF errors
+    image = bytearray(rand.getrandbits(8) for _ in range(61))
+    image[8:16] = bytes(8)
+    engine = ErrorDetection(image, METHODS)
+    num_bits = engine.num_bits
+
+    for method in engine.methods:
+        reference = measure_collision.fast_checksum(bytes(image), method)
+
+        # random patterns
+        patterns = []
+        for i in range(Num_patterns):
+            patterns.append(get_error_pattern(rand.choice(PATTERNS + ['bits:5', 'burst:40']), num_bits, rand))
+
+        # undetectable patterns
+        if method in CRC_PARAMETERS:
+            width, poly, refin = CRC_PARAMETERS[method]
+            for shift in range(0, num_bits - width, 7):
+                patterns.append(crc_undetected_pattern(len(image), width, poly, refin, shift))
+        else:
+            patterns.append(list(range(64, 72)))
+            patterns.append(list(range(64, 128)))
+
+        # compare engine result with full calculation
+        num_undetected = 0
+        for flips in patterns:
+            data = bytearray(image)
+            for j in flips:
+                data[j // 8] ^= 0x80 >> (j % 8)
+            expected = (measure_collision.fast_checksum(bytes(data), method) == reference)
+            if engine.undetected(method, flips) != expected:
+                raise ValueError("%s: wrong result for flipped bits %s" % (method, str(sorted(flips))))
+            num_undetected += expected
+
+        # ensure that undetected case has been covered
+        if num_undetected == 0:
+            raise ValueError("%s: no undetected errors checked" % method)
+
+
+def __init_worker(Image, Methods):
+    """ initialize worker process, i.e. precalculate tables once """
+    global __CONTEXT
+    __CONTEXT = ErrorDetection(Image, Methods)
+
+
+def __count_undetected(args):
+    """
+    Count undetected errors for random patterns. Is executed in parallel by worker processes
+
+    Args:
+        args (tuple): pattern type, number of patterns, seed
+
+    Returns:
+        tuple: pattern type and {method: number of undetected errors}
+    """
+
+    pattern, num_patterns, seed = args
+    engine = __CONTEXT
+    rand = random.Random(seed)
+    undetected = {method: 0 for method in engine.methods}
+
+    for _ in range(num_patterns):
+        flips = get_error_pattern(pattern, engine.num_bits, rand)
+        for method in engine.methods:
+            if engine.undetected(method, flips):
+                undetected[method] += 1
+
+    return pattern, undetected
+
+
+def measure_error_detection(Image:bytes, Patterns:list, Num_patterns:int, Methods:list, Num_processes:int=None, Seed:int=0) -> dict:
+    """
+    Measure rate of undetected errors
+
+    Args:
+        Image (bytes): base image
+        Patterns (list): error pattern types, e.g. ['bits:2', 'burst:17']
+        Num_patterns (int): number of random patterns per pattern type
+        Methods (list): checksum methods, e.g. ['crc16', 'fletcher16']
+        Num_processes (int): number of parallel processes (None = number of CPU cores)
+        Seed (int): seed of random generator, for reproducible results
+
+    Returns:
+        dict: number of undetected errors as {pattern: {method: count}}
+    """
+
+    for pattern in Patterns:
+        check_pattern(pattern, len(Image))
+
+    # split patterns in tasks of max. 1E5 patterns for progress indicator and load balancing
+    tasks = []
+    for pattern in Patterns:
+        remaining = Num_patterns
+        while remaining > 0:
+            num = min(remaining, 100000)
+            tasks.append((pattern, num, Seed + len(tasks)))
+            remaining -= num
+
+    # distribute tasks to all CPU cores (default) and print progress
+    result = {pattern: {method.upper(): 0 for method in Methods} for pattern in Patterns}
+    if Num_processes is None:
+        Num_processes = os.cpu_count() or 1
+    with multiprocessing.Pool(processes=Num_processes, initializer=__init_worker, initargs=(bytes(Image), Methods)) as pool:
+        for pattern, undetected in pool.imap_unordered(__count_undetected, tasks):
+            for method, count in undetected.items():
+                result[pattern][method] += count
+            print(".", end="", flush=True)
+
+    return result
+
+
+if __name__ == '__main__':
+
+    import time
+
+    # commandline parameters
+    parser = argparse.ArgumentParser(description="Measure rate of undetected bit errors for checksums")
+    parser.add_argument("-i", "--image", default=None, help="base image (*.ihx, *.hex, *.bin). Default: random data")
+    parser.add_argument("-s", "--size", type=int, default=1024, help="size of random image [B] (default: 1024)")
+    parser.add_argument("--start", type=lambda x: int(x, 0), default=None, help="first address of image (default: from file)")
+    parser.add_argument("--end", type=lambda x: int(x, 0), default=None, help="last address of image (default: from file)")
+    parser.add_argument("--fill", type=lambda x: int(x, 0), default=0x00, help="value of unused flash (default: 0x00)")
+    parser.add_argument("-p", "--pattern", action="append", default=None, help="error pattern bits:K or burst:L (default: %s)" % " ".join(PATTERNS))
+    parser.add_argument("-m", "--method", action="append", default=None, choices=METHODS, help="checksum method (default: all)")
+    parser.add_argument("-n", "--num", type=float, default=1E6, help="number of random patterns per pattern type (default: 1e6)")
+    parser.add_argument("-j", "--processes", type=int, default=None, help="number of parallel processes (default: number of CPU cores)")
+    parser.add_argument("--seed", type=int, default=0, help="seed for random generator (default: 0)")
+    args = parser.parse_args()
+    patterns = args.pattern if args.pattern else PATTERNS
+    methods = args.method if args.method else METHODS
+    num_patterns = int(args.num)
+
+    # get base image from file or random data
+    if args.image:
+        image = image_file.read_image(args.image, Start=args.start, End=args.end, Fill=args.fill)
+    else:
+        image = random.Random(args.seed).randbytes(args.size)
+
+    # check engine vs. full checksum calculation
+    check_engine(Seed=args.seed)
+
+    # measure undetected error rates
+    print("Start %g patterns x %d types, %dB image " % (num_patterns, len(patterns), len(image)), end="", flush=True)
+    timeStart = time.time()
+    result = measure_error_detection(image, patterns, num_patterns, methods, Num_processes=args.processes, Seed=args.seed)
+    timeEnd = time.time()
+    print(" done after %ds\n" % (timeEnd-timeStart))
+
+    # print result table: undetected errors and rate [ppm]
+    print("pattern\t" + "\t".join(["%-12s" % method for method in methods]))
+    for pattern in patterns:
+        line = "%-8s" % pattern
+        for method in methods:
+            count = result[pattern][method.upper()]
+            line += "\t%-12s" % ("%d/%.3gppm" % (count, count / num_patterns * 1000000))
+        print(line)
@@ -0,0 +1,245 @@
+/**********************
+
+  Host micro-benchmark of common libraries (checksum, memory access, SW clock, stdio)
+
+  Functionality:
+    - fill simulated memory with reproducible pseudo-random data
+    - run each benchmark BENCH_RUNS times and measure wall time via clock_gettime()
+    - print result table in same format as "../../benchmark", but times in ns
+    - print checksums over benchmark range as comments, e.g. for comparison with "../checksum/test_checksums"
+    - drift of micros() over 1h emulated time vs. ideal reference clock of "host_mock.c"
+
+  Note:
+    - host times only show relative changes of the C implementation, e.g. LUT vs. bitwise CRC16.
+      STM8 cycles are measured on target or in ucsim via "../../benchmark"
+    - TIM4 and UART are emulated, see "host_mock.c"
+
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include <time.h>
+#include "host_mock.h"
+#include "sw_clock.h"
+#include "uart_stdio.h"
+#include "memory_access.h"
+#include "checksum_crc16.h"
+#include "checksum_fletcher16.h"
+
+
+/*----------------------------------------------------------
+    MACROS / DEFINES
+----------------------------------------------------------*/
+
+// number of runs per benchmark
+#define BENCH_RUNS      100
+
+// number of bytes for checksum and memory access benchmarks
+#define BENCH_BYTES     65536L
+
+// start address for benchmarks (= flash start)
+#define BENCH_ADDR      0x8000
+
+// emulated duration of micros() drift benchmark [us]
+#define DRIFT_DURATION  3600000000ULL
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// buffer for block read
+uint8_t           buf[BENCH_BYTES];
+
+// result sink, avoids that compiler removes benchmarked code
+volatile uint32_t sink;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/////////////////
+// get monotonic time [ns]
+/////////////////
+static uint64_t time_ns(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec) * 1000000000ULL + (uint64_t) ts.tv_nsec;
+
+} // time_ns()
+
+
+
+/////////////////
+// benchmark functions. Each processes 'units' bytes or calls
+/////////////////
+static void bench_crc16_range(void)     { sink = crc16_ccitt_range(BENCH_ADDR, BENCH_ADDR+BENCH_BYTES-1); }
+static void bench_crc16_block(void)     { sink = crc16_ccitt_block(crc16_ccitt_initialize(), &(g_hostMemory[BENCH_ADDR]), (uint16_t) (BENCH_BYTES-1)); }
+static void bench_fletcher16_range(void){ sink = fletcher16_chk_range(BENCH_ADDR, BENCH_ADDR+BENCH_BYTES-1); }
+static void bench_read_block_far(void)  { read_block_far(BENCH_ADDR, buf, (uint16_t) (BENCH_BYTES-1)); }
+static void bench_micros(void)          { sink = micros(); }
+static void bench_millis(void)          { sink = millis(); }
+static void bench_delay(void)           { delay(1); }
+
+static void bench_crc16_update(void)
+{
+  uint16_t  chk = crc16_ccitt_initialize();
+  uint32_t  i;
+
+  for (i = 0; i < BENCH_BYTES; i++)
+    chk = crc16_ccitt_update(chk, read_1B_far(BENCH_ADDR + i));
+  sink = crc16_ccitt_finalize(chk);
+
+} // bench_crc16_update()
+
+static void bench_fletcher16_update(void)
+{
+  uint16_t  chk = fletcher16_chk_initialize();
+  uint32_t  i;
+
+  for (i = 0; i < BENCH_BYTES; i++)
+    chk = fletcher16_chk_update(chk, read_1B_far(BENCH_ADDR + i));
+  sink = fletcher16_chk_finalize(chk);
+
+} // bench_fletcher16_update()
+
+static void bench_putchar(void)
+{
+  putchar('.');
+
+} // bench_putchar()
+
+
+
+/////////////////
+// benchmark table: name, function, units (bytes or calls) per run
+/////////////////
+static const struct
+{
+  const char  *name;
+  void        (*func)(void);
+  uint32_t    units;
+} benchmarks[] = {
+  { "crc16_ccitt_range",     bench_crc16_range,        BENCH_BYTES   },
+  { "crc16_ccitt_block",     bench_crc16_block,        BENCH_BYTES-1 },
+  { "crc16_ccitt_update",    bench_crc16_update,       BENCH_BYTES   },
+  { "fletcher16_chk_range",  bench_fletcher16_range,   BENCH_BYTES   },
+  { "fletcher16_chk_update", bench_fletcher16_update,  BENCH_BYTES   },
+  { "read_block_far",        bench_read_block_far,     BENCH_BYTES-1 },
+  { "micros",                bench_micros,             1             },
+  { "millis",                bench_millis,             1             },
+  { "delay_1ms",             bench_delay,              1             },
+  { "putchar",               bench_putchar,            1             }
+};
+#define NUM_BENCH   (sizeof(benchmarks)/sizeof(benchmarks[0]))
+
+
+
+/////////////////
+// micros() drift vs. ideal clock over DRIFT_DURATION, with one TIM4 step (4us) between reads
+/////////////////
+static void bench_drift(void)
+{
+  uint64_t  ref0, elapsed = 0, err, errMax = 0;
+  uint32_t  usOld, us, nonMonotonic = 0;
+  uint64_t  tStart, dt;
+
+  tStart = time_ns();
+  ref0   = g_hostTimeUs;
+  usOld  = micros();
+  while (g_hostTimeUs - ref0 < DRIFT_DURATION)
+  {
+    host_tim4_step(1);
+    us = micros();
+
+    // accumulate via differences, i.e. robust against 32-bit overflow of micros()
+    if ((int32_t) (us - usOld) < 0)
+      nonMonotonic++;
+    elapsed += (uint32_t) (us - usOld);
+    usOld = us;
+
+    // max. deviation from reference clock
+    err = (elapsed > g_hostTimeUs - ref0) ? (elapsed - (g_hostTimeUs - ref0)) : ((g_hostTimeUs - ref0) - elapsed);
+    if (err > errMax)
+      errMax = err;
+  }
+  dt = time_ns() - tStart;
+
+  printf("# micros drift: %lld us after %lld us emulated time (max. deviation %lld us, %ld non-monotonic reads, %lld ms host time)\n",
+    (long long) elapsed - (long long) (g_hostTimeUs - ref0), (long long) (g_hostTimeUs - ref0), (long long) errMax,
+    (long) nonMonotonic, (long long) (dt / 1000000));
+
+} // bench_drift()
+
+
+
+/////////////////
+//  main routine
+/////////////////
+int main(void)
+{
+  uint64_t  tStart, dt, min, max, total;
+  uint8_t   i, run;
+
+
+  /////////////
+  // initialization
+  /////////////
+
+  // reproducible memory content
+  host_memory_init(1);
+
+  // start emulated 1ms clock via TIM4
+  init_SW_clock();
+
+  // bind stdio output to emulated UART
+  host_uart_init();
+
+
+  /////////////
+  // run benchmarks and print results
+  /////////////
+  printf("# host benchmark: runs=%d, CRC16_CCITT_IMPL=%d\n", (int) BENCH_RUNS, (int) CRC16_CCITT_IMPL);
+  printf("# name\tunits\truns\tmin\tmax\tavg\tavg/unit*100 [ns]\n");
+  for (i = 0; i < NUM_BENCH; i++)
+  {
+    min   = UINT64_MAX;
+    max   = 0;
+    total = 0;
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+      tStart = time_ns();
+      (benchmarks[i].func)();
+      dt = time_ns() - tStart;
+      if (dt < min) min = dt;
+      if (dt > max) max = dt;
+      total += dt;
+    }
+    printf("BENCH\t%s\t%ld\t%d\t%lld\t%lld\t%lld\t%lld\n", benchmarks[i].name, (long) benchmarks[i].units, (int) BENCH_RUNS,
+      (long long) min, (long long) max, (long long) (total / BENCH_RUNS), (long long) ((total * 100) / BENCH_RUNS / benchmarks[i].units));
+  }
+
+  // checksums over benchmark range, e.g. for comparison with Python reference
+  printf("# crc16 0x%04x, fletcher16 0x%04x over 0x%04x..0x%05lx (LCG seed 1)\n", (int) crc16_ccitt_range(BENCH_ADDR, BENCH_ADDR+BENCH_BYTES-1),
+    (int) fletcher16_chk_range(BENCH_ADDR, BENCH_ADDR+BENCH_BYTES-1), (int) BENCH_ADDR, (long) (BENCH_ADDR+BENCH_BYTES-1));
+
+  // accumulated error of micros() vs. ideal clock
+  bench_drift();
+
+  // emulated time and UART output
+  printf("# emulated: millis %ld, UART bytes %ld\n", (long) millis(), (long) g_hostUartTxCount);
+  printf("# end\n");
+
+  return 0;
+
+} // main()
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,323 @@
+/**********************
+  implementation of host emulation of STM8 peripherals for mock "stm8s.h"
+
+  TIM4 steps are triggered by nop() and wfi(), AWU wake-up by halt(), see "stm8s.h".
+  The TIM4 ISR ticks SW clock, SW timer and scheduler like stm8s_it.c of the examples.
+  UART TX data is collected in a buffer, RX data is provided from a string.
+  Global variables of the common libraries are defined here (_MAIN_).
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <string.h>
+#include "host_mock.h"
+#define _MAIN_            // required for global variables
+  #include "sw_clock.h"
+  #include "sw_timer.h"
+  #include "scheduler.h"
+  #include "uart_stdio.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+TIM4_TypeDef    g_hostTIM4;
+uint8_t         g_hostMemory[HOST_MEMORY_SIZE];
+uint64_t        g_hostTimeUs = 0;
+uint8_t         g_hostUartTx[HOST_UART_TX_SIZE];
+uint32_t        g_hostUartTxCount = 0;
+volatile bool   g_hostUartTxeIT = FALSE;
+int32_t         g_hostLsiErrorPpm = 0;
+uint32_t        g_hostAwuCount = 0;
+uint32_t        g_hostTim4Count = 0;
+
+
+/*----------------------------------------------------------
+    MODULE VARIABLES
+----------------------------------------------------------*/
+
+// data for emulated UART reception
+static const char   *s_uartRx = NULL;
+
+// emulated AWU: selected timebase, enable and wake-up flag
+static AWU_Timebase_TypeDef s_awuTimebase = AWU_TIMEBASE_NO_IT;
+static bool                 s_awuEnable = FALSE;
+static FlagStatus           s_awuFlag = RESET;
+
+// nominal durations of AWU timebases [us], see AWU_Timebase_TypeDef
+static const uint32_t       s_awuDuration[] = { 0, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000, 64000,
+                                                128000, 256000, 512000, 1000000, 2000000, 12000000, 30000000 };
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+// emulated UART send. Store byte in TX buffer
+static void host_UART_SendData8(uint8_t Data)
+{
+  g_hostUartTx[g_hostUartTxCount % HOST_UART_TX_SIZE] = Data;
+  g_hostUartTxCount++;
+
+} // host_UART_SendData8()
+
+
+// emulated UART receive. Return next byte of RX string
+static uint8_t host_UART_ReceiveData8(void)
+{
+  if ((s_uartRx == NULL) || (*s_uartRx == '\0'))
+    return 0;
+  return (uint8_t) *(s_uartRx++);
+
+} // host_UART_ReceiveData8()
+
+
+// emulated UART status. Transmission is immediate, RXNE while RX string has data
+static FlagStatus host_UART_GetFlagStatus(UART1_Flag_TypeDef Flag)
+{
+  if ((Flag == UART1_FLAG_TXE) || (Flag == UART1_FLAG_TC))
+    return SET;
+  if (Flag == UART1_FLAG_RXNE)
+    return ((s_uartRx != NULL) && (*s_uartRx != '\0')) ? SET : RESET;
+  return RESET;
+
+} // host_UART_GetFlagStatus()
+
+
+// emulated UART interrupt config. Only store TXE interrupt state, the TX ISR is called by the test (see test_host.c)
+static void host_UART_ITConfig(UART1_IT_TypeDef IT, FunctionalState NewState)
+{
+  if (IT == UART1_IT_TXE)
+    g_hostUartTxeIT = (NewState != DISABLE) ? TRUE : FALSE;
+
+} // host_UART_ITConfig()
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void host_tim4_step(uint16_t Steps)
+
+  \brief advance emulated TIM4
+
+  \param[in]  Steps   number of counter steps, or 0 to run until next overflow
+
+  Advance TIM4 counter if enabled. On overflow set update flag and call TIM4 ISR handlers 
+  of SW clock, SW timer and scheduler if enabled. Each step advances the ideal reference time g_hostTimeUs by 4us (250kHz TIM4 clock).
+*/
+void host_tim4_step(uint16_t Steps)
+{
+  // timer stopped
+  if (!(TIM4->CR1 & TIM4_CR1_CEN))
+    return;
+
+  do
+  {
+    g_hostTimeUs += 4;
+
+    // overflow -> restart counter and call ISR
+    if (TIM4->CNTR >= TIM4->ARR)
+    {
+      TIM4->CNTR = 0;
+      TIM4->SR1 |= TIM4_FLAG_UPDATE;
+      if (TIM4->IER & TIM4_IT_UPDATE)
+      {
+        g_hostTim4Count++;
+        ISR_TIM4_handler();
+        sw_timer_tick();
+        ISR_scheduler_tick();
+      }
+      if (Steps == 0)
+        break;
+    }
+    else
+      TIM4->CNTR++;
+
+  } while ((Steps == 0) || (--Steps));
+
+} // host_tim4_step()
+
+
+
+/**
+  \fn void host_halt(void)
+
+  \brief emulated active-halt
+
+  With AWU enabled, TIM4 is stopped and the reference time g_hostTimeUs advances by the AWU timebase,
+  scaled by the LSI error g_hostLsiErrorPpm. Then the AWU ISR is called (SW_CLOCK_TICKLESS).
+  Else run TIM4 until next overflow, like wfi().
+*/
+void host_halt(void)
+{
+  if ((s_awuEnable == TRUE) && (s_awuTimebase != AWU_TIMEBASE_NO_IT))
+  {
+    g_hostTimeUs += ((int64_t) s_awuDuration[s_awuTimebase] * (1000000L + g_hostLsiErrorPpm)) / 1000000L;
+    g_hostAwuCount++;
+    s_awuFlag = SET;
+    #if defined(SW_CLOCK_TICKLESS)
+      ISR_AWU_handler();
+    #endif
+    return;
+  }
+
+  host_tim4_step(0);
+
+} // host_halt()
+
+
+
+/**
+  \fn void host_memory_init(uint32_t Seed)
+
+  \brief fill simulated memory with pseudo-random data
+
+  \param[in]  Seed   start value of LCG. Same seed gives same memory content
+*/
+void host_memory_init(uint32_t Seed)
+{
+  uint32_t  i;
+
+  for (i = 0; i < HOST_MEMORY_SIZE; i++)
+  {
+    Seed = Seed * 1103515245UL + 12345UL;
+    g_hostMemory[i] = (uint8_t) (Seed >> 16);
+  }
+
+} // host_memory_init()
+
+
+
+/**
+  \fn void host_uart_init(void)
+
+  \brief bind uart_stdio to emulated UART
+
+  Set SPL function pointers of uart_stdio.h to emulated UART and clear TX buffer.
+*/
+void host_uart_init(void)
+{
+  g_UART_SendData8     = &host_UART_SendData8;
+  g_UART_ReceiveData8  = &host_UART_ReceiveData8;
+  g_UART_GetFlagStatus = &host_UART_GetFlagStatus;
+  g_UART_ITConfig      = &host_UART_ITConfig;
+  g_hostUartTxCount    = 0;
+  g_hostUartTxeIT      = FALSE;
+  s_uartRx             = NULL;
+  memset(g_hostUartTx, 0, sizeof(g_hostUartTx));
+
+} // host_uart_init()
+
+
+
+/**
+  \fn void host_uart_receive(const char *Data)
+
+  \brief provide data for emulated UART reception
+
+  \param[in]  Data   zero-terminated string, which is returned byte-wise by uart_read(). Must stay valid
+*/
+void host_uart_receive(const char *Data)
+{
+  s_uartRx = Data;
+
+} // host_uart_receive()
+
+
+
+/**
+  \fn void TIM4_DeInit(void)
+
+  \brief emulated SPL function. Reset TIM4 registers
+*/
+void TIM4_DeInit(void)
+{
+  memset((void*) &g_hostTIM4, 0, sizeof(g_hostTIM4));
+  TIM4->ARR = 0xFF;
+
+} // TIM4_DeInit()
+
+
+/// emulated SPL function. Set prescaler and auto-reload
+void TIM4_TimeBaseInit(uint8_t Prescaler, uint8_t Period)
+{
+  TIM4->PSCR = Prescaler;
+  TIM4->ARR  = Period;
+
+} // TIM4_TimeBaseInit()
+
+
+/// emulated SPL function. Clear status flag
+void TIM4_ClearFlag(uint8_t Flag)
+{
+  TIM4->SR1 &= (uint8_t) ~Flag;
+
+} // TIM4_ClearFlag()
+
+
+/// emulated SPL function. Enable/disable interrupt
+void TIM4_ITConfig(uint8_t IT, FunctionalState NewState)
+{
+  if (NewState != DISABLE)
+    TIM4->IER |= IT;
+  else
+    TIM4->IER &= (uint8_t) ~IT;
+
+} // TIM4_ITConfig()
+
+
+/// emulated SPL function. Start/stop counter
+void TIM4_Cmd(FunctionalState NewState)
+{
+  if (NewState != DISABLE)
+    TIM4->CR1 |= TIM4_CR1_CEN;
+  else
+    TIM4->CR1 &= (uint8_t) ~TIM4_CR1_CEN;
+
+} // TIM4_Cmd()
+
+
+/// emulated SPL function. Clear interrupt flag
+void TIM4_ClearITPendingBit(uint8_t IT)
+{
+  TIM4->SR1 &= (uint8_t) ~IT;
+
+} // TIM4_ClearITPendingBit()
+
+
+
+/// emulated SPL function. Select AWU timebase and enable AWU
+void AWU_Init(AWU_Timebase_TypeDef AWU_TimeBase)
+{
+  s_awuTimebase = AWU_TimeBase;
+  s_awuEnable   = TRUE;
+
+} // AWU_Init()
+
+
+/// emulated SPL function. Enable/disable AWU
+void AWU_Cmd(FunctionalState NewState)
+{
+  s_awuEnable = (NewState != DISABLE) ? TRUE : FALSE;
+
+} // AWU_Cmd()
+
+
+/// emulated SPL function. Return and clear AWU wake-up flag (cleared by reading AWU_CSR)
+FlagStatus AWU_GetFlagStatus(void)
+{
+  FlagStatus  flag = s_awuFlag;
+
+  s_awuFlag = RESET;
+  return flag;
+
+} // AWU_GetFlagStatus()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
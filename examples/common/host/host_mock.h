@@ -0,0 +1,59 @@
+/**********************
+  declaration of host emulation of STM8 peripherals for mock "stm8s.h"
+
+  TIM4 steps are triggered by nop() and wfi(), AWU wake-up by halt(), see "stm8s.h".
+  UART TX data is collected in a buffer, RX data is provided from a string.
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _HOST_MOCK_H_
+#define _HOST_MOCK_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// size of buffer for emulated UART output [B]. Older data is overwritten
+#define HOST_UART_TX_SIZE     1024
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+extern uint8_t        g_hostUartTx[HOST_UART_TX_SIZE];  ///< emulated UART output (ring buffer)
+extern uint32_t       g_hostUartTxCount;                ///< number of bytes sent via emulated UART
+extern volatile bool  g_hostUartTxeIT;                  ///< emulated UART TXE interrupt enabled, see ISR_UART_TX_handler()
+extern int32_t        g_hostLsiErrorPpm;                ///< error of emulated LSI [ppm], i.e. real vs. nominal AWU duration
+extern uint32_t       g_hostAwuCount;                   ///< number of wake-ups from active-halt by emulated AWU
+extern uint32_t       g_hostTim4Count;                  ///< number of emulated TIM4 interrupts
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief fill simulated memory with pseudo-random data (reproducible via seed)
+void host_memory_init(uint32_t Seed);
+
+/// @brief bind uart_stdio to emulated UART and clear TX buffer
+void host_uart_init(void);
+
+/// @brief provide data to be received by emulated UART
+void host_uart_receive(const char *Data);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _HOST_MOCK_H_
@@ -0,0 +1,156 @@
+/**********************
+  host mock of SPL "stm8s.h" for compiling the common libraries on a PC
+
+  Provides SPL types, the used TIM4, AWU and UART declarations, and memory access
+  macros for a simulated 24-bit address range. Peripheral registers are plain
+  variables, which are emulated in host_mock.c:
+    - TIM4 counts one step per nop() and runs to the next overflow per wfi()/halt(),
+      i.e. busy loops of sw_clock.c advance the emulated time
+    - with AWU enabled, halt() advances the reference time by the AWU duration (incl. LSI error)
+      with TIM4 stopped, and calls the AWU ISR (SW_CLOCK_TICKLESS)
+    - UART is accessed via the SPL function pointers of uart_stdio.h (UART_STDIO_PORT=0)
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef __STM8S_H
+#define __STM8S_H
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+// host libc has same stdio prototypes as SDCC, e.g. int putchar(int)
+#define _SDCC_
+
+/// size of simulated memory (24-bit address range up to 0x2FFFF)
+#define HOST_MEMORY_SIZE      0x30000
+
+// access to simulated memory. memory_access.h has no branch for host compilers
+#define read_1B(addr)         (g_hostMemory[(uint16_t) (addr)])
+#define write_1B(addr,val)    (g_hostMemory[(uint16_t) (addr)] = (val))
+#define read_1B_far(addr)     (g_hostMemory[(uint32_t) (addr) % HOST_MEMORY_SIZE])
+#define read_2B_far(addr)     ((uint16_t) ((read_1B_far(addr) << 8) | read_1B_far((addr)+1)))
+#define read_4B_far(addr)     ((((uint32_t) read_2B_far(addr)) << 16) | read_2B_far((addr)+2))
+#define write_1B_far(addr,val)  (g_hostMemory[(uint32_t) (addr) % HOST_MEMORY_SIZE] = (val))
+
+// core instructions. nop() and wfi() advance the emulated TIM4, halt() waits for AWU (if enabled)
+#define nop()                 host_tim4_step(1)
+#define wfi()                 host_tim4_step(0)
+#define halt()                host_halt()
+#define enableInterrupts()
+#define disableInterrupts()
+
+// TIM4 (see "stm8s_tim4.h")
+#define TIM4_SR1_RESET_VALUE  ((uint8_t) 0x00)
+#define TIM4_PRESCALER_64     ((uint8_t) 0x06)
+#define TIM4_FLAG_UPDATE      ((uint8_t) 0x01)
+#define TIM4_IT_UPDATE        ((uint8_t) 0x01)
+#define TIM4_CR1_CEN          ((uint8_t) 0x01)
+#define TIM4                  (&g_hostTIM4)
+
+// UART (see "stm8s_uart1.h"). Only status flags and TXE interrupt are used by uart_stdio
+#define UART1_FLAG_TXE        ((uint16_t) 0x0080)
+#define UART1_FLAG_TC         ((uint16_t) 0x0040)
+#define UART1_FLAG_RXNE       ((uint16_t) 0x0020)
+#define UART1_FLAG_OR         ((uint16_t) 0x0008)
+#define UART1_FLAG_FE         ((uint16_t) 0x0002)
+#define UART1_IT_TXE          ((uint16_t) 0x0277)
+#define UART1_CR2_TIEN        ((uint8_t) 0x80)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+typedef enum {FALSE = 0, TRUE = !FALSE} bool;
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus, BitStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+/// AWU timebases (see "stm8s_awu.h")
+typedef enum
+{
+  AWU_TIMEBASE_NO_IT  = (uint8_t) 0,
+  AWU_TIMEBASE_250US  = (uint8_t) 1,
+  AWU_TIMEBASE_500US  = (uint8_t) 2,
+  AWU_TIMEBASE_1MS    = (uint8_t) 3,
+  AWU_TIMEBASE_2MS    = (uint8_t) 4,
+  AWU_TIMEBASE_4MS    = (uint8_t) 5,
+  AWU_TIMEBASE_8MS    = (uint8_t) 6,
+  AWU_TIMEBASE_16MS   = (uint8_t) 7,
+  AWU_TIMEBASE_32MS   = (uint8_t) 8,
+  AWU_TIMEBASE_64MS   = (uint8_t) 9,
+  AWU_TIMEBASE_128MS  = (uint8_t) 10,
+  AWU_TIMEBASE_256MS  = (uint8_t) 11,
+  AWU_TIMEBASE_512MS  = (uint8_t) 12,
+  AWU_TIMEBASE_1S     = (uint8_t) 13,
+  AWU_TIMEBASE_2S     = (uint8_t) 14,
+  AWU_TIMEBASE_12S    = (uint8_t) 15,
+  AWU_TIMEBASE_30S    = (uint8_t) 16
+
+} AWU_Timebase_TypeDef;
+
+typedef uint16_t      UART1_Flag_TypeDef;
+typedef uint16_t      UART1_IT_TypeDef;
+
+/// TIM4 registers
+typedef struct
+{
+  volatile uint8_t    CR1;          ///< control register 1
+  volatile uint8_t    IER;          ///< interrupt enable register
+  volatile uint8_t    SR1;          ///< status register 1
+  volatile uint8_t    EGR;          ///< event generation register
+  volatile uint8_t    CNTR;         ///< counter register
+  volatile uint8_t    PSCR;         ///< prescaler register
+  volatile uint8_t    ARR;          ///< auto-reload register
+
+} TIM4_TypeDef;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+extern TIM4_TypeDef   g_hostTIM4;                     ///< emulated TIM4 registers
+extern uint8_t        g_hostMemory[HOST_MEMORY_SIZE]; ///< simulated memory
+extern uint64_t       g_hostTimeUs;                   ///< ideal reference time [us]. Advanced by 4us per TIM4 step
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief advance emulated TIM4 by steps (0 = until next overflow) and call TIM4 ISR on overflow
+void host_tim4_step(uint16_t Steps);
+
+/// SPL TIM4 functions used by sw_clock.c
+void TIM4_DeInit(void);
+void TIM4_TimeBaseInit(uint8_t Prescaler, uint8_t Period);
+void TIM4_ClearFlag(uint8_t Flag);
+void TIM4_ITConfig(uint8_t IT, FunctionalState NewState);
+void TIM4_Cmd(FunctionalState NewState);
+void TIM4_ClearITPendingBit(uint8_t IT);
+
+/// @brief enter active-halt. With AWU enabled wake up after AWU timebase, else run TIM4 until next overflow
+void host_halt(void);
+
+/// SPL AWU functions used by sw_clock.c (SW_CLOCK_TICKLESS)
+void AWU_Init(AWU_Timebase_TypeDef AWU_TimeBase);
+void AWU_Cmd(FunctionalState NewState);
+FlagStatus AWU_GetFlagStatus(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // __STM8S_H
@@ -0,0 +1,5 @@
+/**********************
+  host mock of SPL "stm8s_uart1.h". UART types are declared in mock "stm8s.h"
+**********************/
+
+#include "stm8s.h"
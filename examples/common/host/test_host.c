@@ -0,0 +1,761 @@
+/**********************
+
+  Host unit tests of common libraries (checksum, memory access, SW clock, stdio)
+
+  Functionality:
+    - CRC16-CCITT: check value "123456789" and Python reference values (crc_lut.py) for range, block and update
+    - Fletcher-16: Python reference values (fletcher.py), and range/block vs. fletcher16_chk_update() for random ranges
+    - memory access: read_block_far() and read_range_far() across 64kB bank boundaries
+    - SW clock: micros() and millis() are monotonic and consistent with emulated TIM4
+    - SW clock: micros(), millis(), uptime_ms() and uptime_us() across 2^32us, 2^32ms and 48-bit wrap, with and w/o pending TIM4 overflow
+    - SW clock: sleep_ms() in wait mode and active-halt (AWU) updates g_millis, g_micros and g_millisHigh (incl. carry),
+      and print accuracy vs. reference clock for different LSI errors
+    - SW clock: tickless sleep_ms() halts only until the next SW timer expiry or scheduler release,
+      i.e. timers fire and tasks are released on time, and wheel and scheduler catch up the halt duration
+    - UART stdio: TX/RX ring buffer wrap, TX overflow (DROP or BLOCK, see UART_TX_OVERFLOW), uart_read() without data
+    - print failed checks and return 1 on any failure, see "make test"
+
+  Note:
+    - requires UART_TX_BUFFER_SIZE=UART_RX_BUFFER_SIZE=TEST_UART_BUFFER, SW_CLOCK_UPTIME64 and SW_CLOCK_TICKLESS, see Makefile
+    - UART TX ISR is called from a SIGALRM timer while the TXE interrupt is enabled.
+      UART RX ISR is called by the test for each received byte
+    - Python reference values are for the LCG memory content of host_memory_init(1)
+
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "host_mock.h"
+#include "sw_clock.h"
+#include "sw_timer.h"
+#include "scheduler.h"
+#include "uart_stdio.h"
+#include "memory_access.h"
+#include "checksum_crc16.h"
+#include "checksum_fletcher16.h"
+
+
+/*----------------------------------------------------------
+    MACROS / DEFINES
+----------------------------------------------------------*/
+
+// size of UART TX and RX buffers. Must match build options
+#define TEST_UART_BUFFER    8
+#if (UART_TX_BUFFER_SIZE != TEST_UART_BUFFER) || (UART_RX_BUFFER_SIZE != TEST_UART_BUFFER)
+  #error build with UART_TX_BUFFER_SIZE=UART_RX_BUFFER_SIZE=TEST_UART_BUFFER, see Makefile
+#endif
+
+// uptime_us() requires 64-bit integers, sleep_ms() with AWU requires tickless mode
+#if !defined(SW_CLOCK_UPTIME64) || !defined(SW_CLOCK_TICKLESS)
+  #error build with SW_CLOCK_UPTIME64 and SW_CLOCK_TICKLESS, see Makefile
+#endif
+
+// number of ms before and after counter wrap in clock wrap test. Odd, i.e. wrap with pending overflow, see test_clock_wrap()
+#define TEST_WRAP_MS        5
+
+// duration of tickless sleep with pending SW timers [ms], see test_sleep_timer()
+#define TEST_SLEEP_MS       1000
+
+// number of random ranges for checksum tests
+#define TEST_RANGES         2000
+
+// check condition. On failure print location and message, and count error
+#define CHECK(cond, ...)    check((cond), __LINE__, __VA_ARGS__)
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// number of checks and failures
+static uint32_t             s_checks = 0;
+static uint32_t             s_errors = 0;
+
+// emulated UART TX interrupt. Call ISR_UART_TX_handler() from SIGALRM only if set
+static volatile sig_atomic_t  s_txIsrActive = 0;
+
+// expiries of a SW timer, see timer_fired()
+typedef struct
+{
+  uint8_t     count;                          // number of expiries
+  uint64_t    ref[TEST_SLEEP_MS/100];         // reference time of expiries [us]
+  uint32_t    ms[TEST_SLEEP_MS/100];          // millis() of expiries
+} test_fired_t;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/////////////////
+// count check and print message on failure
+/////////////////
+static void check(int Cond, int Line, const char *Format, ...)
+{
+  va_list   args;
+
+  s_checks++;
+  if (Cond)
+    return;
+
+  s_errors++;
+  printf("FAIL\tline %d: ", Line);
+  va_start(args, Format);
+  vprintf(Format, args);
+  va_end(args);
+  printf("\n");
+
+} // check()
+
+
+
+/////////////////
+// emulated UART TX interrupt. TXE flag is always set, i.e. ISR is pending while TXE interrupt is enabled
+/////////////////
+static void uart_tx_isr(int Signal)
+{
+  (void) Signal;
+
+  if (s_txIsrActive && g_hostUartTxeIT)
+    ISR_UART_TX_handler();
+
+} // uart_tx_isr()
+
+
+
+/////////////////
+// emulated UART RX interrupt. Call RX ISR for each byte of Data
+/////////////////
+static void uart_rx_isr(const char *Data)
+{
+  host_uart_receive(Data);
+  while (*Data++)
+    ISR_UART_RX_handler();
+
+} // uart_rx_isr()
+
+
+
+/////////////////
+// callback for read_range_far(). Append chunk to buffer and count chunks
+/////////////////
+typedef struct
+{
+  uint8_t   *buf;
+  uint32_t  len;
+  uint16_t  chunks;
+  uint8_t   lenLast;
+  uint8_t   lenError;
+} range_ctx_t;
+
+static void range_chunk(void *Ctx, const uint8_t *Buf, uint8_t Len)
+{
+  range_ctx_t *ctx = (range_ctx_t*) Ctx;
+
+  // all chunks except the last must have MEMORY_CHUNK_SIZE bytes
+  if ((ctx->chunks > 0) && (ctx->lenLast != MEMORY_CHUNK_SIZE))
+    ctx->lenError = 1;
+
+  memcpy(ctx->buf + ctx->len, Buf, Len);
+  ctx->len += Len;
+  ctx->lenLast = Len;
+  ctx->chunks++;
+
+} // range_chunk()
+
+
+
+/////////////////
+// test CRC16-CCITT (selected CRC16_CCITT_IMPL)
+/////////////////
+static void test_crc16(void)
+{
+  // Python reference values (crc_lut.py) for memory content of host_memory_init(1)
+  static const struct { uint32_t start, end; uint16_t crc; } ref[] = {
+    { 0x08000, 0x17FFF, 0x2E28 },     // 64kB from flash start
+    { 0x0FFF5, 0x1000A, 0xB031 },     // 22B across bank 0/1
+    { 0x1FFE0, 0x20020, 0xB56C },     // 65B across bank 1/2
+    { 0x12345, 0x1239D, 0x2F50 }      // 89B within bank 1
+  };
+  const char  *str = "123456789";
+  uint8_t     buf[0x10000];
+  uint16_t    chk;
+  uint32_t    addr;
+  uint8_t     i;
+
+  // check value of CRC16/CCITT-FALSE (block and update)
+  CHECK(crc16_ccitt_block(crc16_ccitt_initialize(), (const uint8_t*) str, 9) == 0x29B1, "crc16_ccitt_block('123456789') != 0x29B1");
+  chk = crc16_ccitt_initialize();
+  for (i = 0; i < 9; i++)
+    chk = crc16_ccitt_update(chk, (uint8_t) str[i]);
+  CHECK(crc16_ccitt_finalize(chk) == 0x29B1, "crc16_ccitt_update('123456789') = 0x%04X != 0x29B1", (int) chk);
+
+  // check value of CRC16/CCITT-FALSE (range across bank boundary)
+  host_memory_init(1);
+  for (i = 0; i < 9; i++)
+    write_1B_far(0xFFFC + i, (uint8_t) str[i]);
+  chk = crc16_ccitt_range(0xFFFC, 0xFFFC + 8);
+  CHECK(chk == 0x29B1, "crc16_ccitt_range('123456789') = 0x%04X != 0x29B1", (int) chk);
+
+  // compare range, block and update with Python reference
+  host_memory_init(1);
+  for (i = 0; i < sizeof(ref)/sizeof(ref[0]); i++)
+  {
+    chk = crc16_ccitt_range(ref[i].start, ref[i].end);
+    CHECK(chk == ref[i].crc, "crc16_ccitt_range(0x%05X..0x%05X) = 0x%04X != 0x%04X", (int) ref[i].start, (int) ref[i].end, (int) chk, (int) ref[i].crc);
+
+    read_block_far(ref[i].start, buf, (uint16_t) (ref[i].end - ref[i].start));
+    buf[ref[i].end - ref[i].start] = read_1B_far(ref[i].end);
+    chk = crc16_ccitt_block(crc16_ccitt_initialize(), buf, (uint16_t) (ref[i].end - ref[i].start));
+    chk = crc16_ccitt_update(chk, buf[ref[i].end - ref[i].start]);
+    CHECK(chk == ref[i].crc, "crc16_ccitt_block(0x%05X..0x%05X) = 0x%04X != 0x%04X", (int) ref[i].start, (int) ref[i].end, (int) chk, (int) ref[i].crc);
+
+    chk = crc16_ccitt_initialize();
+    for (addr = ref[i].start; addr <= ref[i].end; addr++)
+      chk = crc16_ccitt_update(chk, read_1B_far(addr));
+    CHECK(chk == ref[i].crc, "crc16_ccitt_update(0x%05X..0x%05X) = 0x%04X != 0x%04X", (int) ref[i].start, (int) ref[i].end, (int) chk, (int) ref[i].crc);
+  }
+
+} // test_crc16()
+
+
+
+/////////////////
+// test Fletcher-16
+/////////////////
+static void test_fletcher16(void)
+{
+  // Python reference values (fletcher.py) for memory content of host_memory_init(1)
+  static const struct { uint32_t start, end; uint16_t chk; } ref[] = {
+    { 0x08000, 0x17FFF, 0xBDFC },     // 64kB from flash start
+    { 0x0FFF5, 0x1000A, 0xC1DE },     // 22B across bank 0/1
+    { 0x1FFE0, 0x20020, 0x89B2 },     // 65B across bank 1/2
+    { 0x12345, 0x1239D, 0x95F3 }      // 89B within bank 1
+  };
+  uint8_t     buf[1024];
+  uint16_t    chk, exp;
+  uint32_t    start, end, addr, split;
+  uint16_t    i;
+  uint8_t     fill;
+
+  // compare range with Python reference
+  host_memory_init(1);
+  for (i = 0; i < sizeof(ref)/sizeof(ref[0]); i++)
+  {
+    chk = fletcher16_chk_range(ref[i].start, ref[i].end);
+    CHECK(chk == ref[i].chk, "fletcher16_chk_range(0x%05X..0x%05X) = 0x%04X != 0x%04X", (int) ref[i].start, (int) ref[i].end, (int) chk, (int) ref[i].chk);
+  }
+
+  // random ranges of random lengths (mostly no multiple of FLETCHER16_BLOCK_MAX) vs. bytewise update with modulo.
+  // Also for worst case memory with all 0xFF
+  srand(42);
+  for (fill = 0; fill < 2; fill++)
+  {
+    if (fill)
+      memset(g_hostMemory, 0xFF, sizeof(g_hostMemory));
+    else
+      host_memory_init(1);
+
+    for (i = 0; i < TEST_RANGES; i++)
+    {
+      // short ranges cover all remainders of FLETCHER16_BLOCK_MAX
+      start = (uint32_t) rand() % (HOST_MEMORY_SIZE - sizeof(buf));
+      end   = start + ((i < 128) ? i : (uint32_t) rand() % sizeof(buf));
+
+      exp = fletcher16_chk_initialize();
+      for (addr = start; addr <= end; addr++)
+        exp = fletcher16_chk_update(exp, read_1B_far(addr));
+
+      chk = fletcher16_chk_range(start, end);
+      CHECK(chk == exp, "fletcher16_chk_range(0x%05X..0x%05X) = 0x%04X != 0x%04X", (int) start, (int) end, (int) chk, (int) exp);
+
+      // block in two parts, continue with previous checksum
+      read_block_far(start, buf, (uint16_t) (end - start + 1));
+      split = (uint32_t) rand() % (end - start + 2);
+      chk = fletcher16_chk_block(fletcher16_chk_initialize(), buf, (uint16_t) split);
+      chk = fletcher16_chk_block(chk, buf + split, (uint16_t) (end - start + 1 - split));
+      CHECK(chk == exp, "fletcher16_chk_block(0x%05X..0x%05X, split %d) = 0x%04X != 0x%04X", (int) start, (int) end, (int) split, (int) chk, (int) exp);
+    }
+  }
+
+} // test_fletcher16()
+
+
+
+/////////////////
+// test read_block_far() and read_range_far() across 64kB bank boundaries
+/////////////////
+static void test_memory(void)
+{
+  static const uint32_t addr[] = { 0x0FFC0, 0x0FFFF, 0x10000, 0x1FFC1, 0x1FFFF, 0x20000 };
+  static const uint16_t len[]  = { 1, 2, MEMORY_CHUNK_SIZE-1, MEMORY_CHUNK_SIZE, MEMORY_CHUNK_SIZE+1, 3*MEMORY_CHUNK_SIZE+7 };
+  uint8_t       buf[1024];
+  range_ctx_t   ctx;
+  uint8_t       i, j;
+
+  host_memory_init(1);
+  for (i = 0; i < sizeof(addr)/sizeof(addr[0]); i++)
+  {
+    for (j = 0; j < sizeof(len)/sizeof(len[0]); j++)
+    {
+      // block read. Check also that no byte behind block is written
+      memset(buf, 0, sizeof(buf));
+      buf[len[j]] = 0x5A;
+      read_block_far(addr[i], buf, len[j]);
+      CHECK(memcmp(buf, &(g_hostMemory[addr[i]]), len[j]) == 0, "read_block_far(0x%05X, %d) data mismatch", (int) addr[i], (int) len[j]);
+      CHECK(buf[len[j]] == 0x5A, "read_block_far(0x%05X, %d) buffer overrun", (int) addr[i], (int) len[j]);
+
+      // range read in chunks
+      memset(&ctx, 0, sizeof(ctx));
+      ctx.buf = buf;
+      read_range_far(addr[i], addr[i] + len[j] - 1, range_chunk, &ctx);
+      CHECK(ctx.len == len[j], "read_range_far(0x%05X, %d) length %d", (int) addr[i], (int) len[j], (int) ctx.len);
+      CHECK(ctx.chunks == (len[j] + MEMORY_CHUNK_SIZE - 1) / MEMORY_CHUNK_SIZE, "read_range_far(0x%05X, %d) %d chunks", (int) addr[i], (int) len[j], (int) ctx.chunks);
+      CHECK(ctx.lenError == 0, "read_range_far(0x%05X, %d) chunk size", (int) addr[i], (int) len[j]);
+      CHECK(memcmp(buf, &(g_hostMemory[addr[i]]), len[j]) == 0, "read_range_far(0x%05X, %d) data mismatch", (int) addr[i], (int) len[j]);
+    }
+  }
+
+} // test_memory()
+
+
+
+/////////////////
+// test micros() and millis() with emulated TIM4 (4us per step, 250 steps per ms)
+/////////////////
+static void test_clock(void)
+{
+  uint32_t  us, ms, usOld, msOld;
+  uint64_t  ref;
+  uint32_t  i;
+
+  init_SW_clock();
+  usOld = micros();
+  msOld = millis();
+  CHECK((usOld == 0) && (msOld == 0), "clock start micros=%ld, millis=%ld", (long) usOld, (long) msOld);
+
+  // single steps incl. TIM4 overflows: micros() +4us per step, millis() monotonic and consistent
+  for (i = 0; i < 10000; i++)
+  {
+    nop();
+    us = micros();
+    ms = millis();
+    CHECK(us - usOld == 4, "micros() step %ld: %ld -> %ld", (long) i, (long) usOld, (long) us);
+    CHECK((ms - msOld <= 1) && (ms == us / 1000), "millis() step %ld: %ld -> %ld (micros %ld)", (long) i, (long) msOld, (long) ms, (long) us);
+    usOld = us;
+    msOld = ms;
+  }
+
+  // drift vs. ideal clock over 60s emulated time (1h see bench_host.c) -> no accumulated error
+  us  = micros();
+  ref = g_hostTimeUs;
+  while (g_hostTimeUs - ref < 60000000ULL)
+    host_tim4_step(1);
+  CHECK(micros() - us == 60000000UL, "micros() drift %ld us after 60s", (long) (micros() - us) - 60000000L);
+
+  // delay() and sleep_ms() advance clock by the requested time
+  us = micros();
+  delay(5);
+  CHECK(micros() - us == 5000, "delay(5) took %ld us", (long) (micros() - us));
+  us = micros();
+  sleep_ms(7);
+  CHECK(micros() - us == 7000, "sleep_ms(7) took %ld us", (long) (micros() - us));
+
+} // test_clock()
+
+
+
+/////////////////
+// test SW clock across counter wraps. Start 'Ms' before wrap of 48-bit ms counter {High,Low}.
+// If 'PendOdd' is set, TIM4 interrupt is disabled around odd overflows, i.e. overflow is pending for 150 steps
+/////////////////
+static void test_clock_wrap(const char *Name, uint16_t High, uint32_t Low, uint8_t PendOdd)
+{
+  const uint64_t  mod_ms = 1ULL << 48;            // 48-bit ms counter
+  const uint64_t  mod_us = mod_ms * 1000ULL;      // uptime_us() after 48-bit ms counter
+  uint32_t        us, ms, usOld, msOld, usStart, msStart;
+  uint64_t        ums, uus, umsOld, uusOld;
+  uint8_t         pending;
+  uint16_t        i;
+
+  // start clock, then seed consistent counters. TIM4 counter is 0, i.e. next overflow after 250 steps
+  init_SW_clock();
+  g_millisHigh = High;
+  g_millis     = Low;
+  g_micros     = Low * 1000UL;                    // modulo 2^32, see init_SW_clock()
+  usOld  = usStart = micros();
+  msOld  = msStart = millis();
+  umsOld = uptime_ms();
+  uusOld = uptime_us();
+
+  for (i = 1; i <= 2 * TEST_WRAP_MS * 250; i++)
+  {
+    // disable TIM4 interrupt 50 steps before odd overflows, and re-enable 100 steps after. Pending overflow is then handled
+    if (PendOdd && (((i + 50) % 500) == 250))
+      TIM4->IER &= ~TIM4_IT_UPDATE;
+    if (PendOdd && ((i % 500) == 350))
+    {
+      TIM4->IER |= TIM4_IT_UPDATE;
+      CHECK(SW_CLOCK_TIM4_OVF(), "%s step %d: no pending overflow", Name, (int) i);
+      ISR_TIM4_handler();
+    }
+
+    nop();
+    pending = SW_CLOCK_TIM4_OVF() ? 1 : 0;
+    us  = micros();
+    ms  = millis();
+    ums = uptime_ms();
+    uus = uptime_us();
+
+    // monotonic: micros() and uptime_us() +4us per step, millis() and uptime_ms() +0/1ms (modulo counter width)
+    CHECK(us - usOld == 4, "%s step %d: micros() %lu -> %lu", Name, (int) i, (unsigned long) usOld, (unsigned long) us);
+    CHECK((uus + mod_us - uusOld) % mod_us == 4, "%s step %d: uptime_us() %llu -> %llu", Name, (int) i,
+      (unsigned long long) uusOld, (unsigned long long) uus);
+    CHECK((ms - msOld) <= 1, "%s step %d: millis() %lu -> %lu", Name, (int) i, (unsigned long) msOld, (unsigned long) ms);
+    CHECK(((ums - umsOld) & (mod_ms - 1)) <= 1, "%s step %d: uptime_ms() %llu -> %llu", Name, (int) i,
+      (unsigned long long) umsOld, (unsigned long long) ums);
+
+    // consistent: 32-bit values are low part of 64-bit values. Pending overflow is included in us, but not yet in ms
+    CHECK((uint32_t) uus == us, "%s step %d: micros() %lu != uptime_us() %llu", Name, (int) i, (unsigned long) us, (unsigned long long) uus);
+    CHECK((uint32_t) ums == ms, "%s step %d: millis() %lu != uptime_ms() %llu", Name, (int) i, (unsigned long) ms, (unsigned long long) ums);
+    CHECK(((uus / 1000) % mod_ms) == ((ums + pending) % mod_ms), "%s step %d: uptime_us() %llu vs. uptime_ms() %llu (pending %d)",
+      Name, (int) i, (unsigned long long) uus, (unsigned long long) ums, (int) pending);
+
+    usOld  = us;
+    msOld  = ms;
+    umsOld = ums;
+    uusOld = uus;
+  }
+
+  // counters have wrapped
+  CHECK((micros() < usStart) || (millis() < msStart) || (g_millisHigh != High), "%s: no counter wrap", Name);
+
+} // test_clock_wrap()
+
+
+
+/////////////////
+// test sleep_ms() in wait mode (< SW_CLOCK_AWU_MIN) and active-halt with AWU wake-up (static sleep_awu())
+/////////////////
+static void test_sleep(void)
+{
+  static const uint32_t duration[] = { 1, SW_CLOCK_AWU_MIN-1, SW_CLOCK_AWU_MIN, 100, 1000, 45000 };
+  static const int32_t  lsiError[] = { 0, -10000, 10000 };     // LSI error [ppm]
+  uint32_t              us, awu;
+  uint64_t              ref, ums;
+  int64_t               err;
+  uint8_t               i, j;
+
+  ////////
+  // carry into g_millisHigh during AWU sleep: 100ms = AWU 64ms (with carry) + AWU 32ms + wait mode 4ms
+  ////////
+  init_SW_clock();
+  g_millisHigh = 0x1234;
+  g_millis     = 0xFFFFFFFFUL - 10;
+  g_micros     = g_millis * 1000UL;
+  for (i = 0; i < 100; i++)                               // sub-ms phase is kept
+    nop();
+  us  = micros();
+  awu = g_hostAwuCount;
+  ref = g_hostTimeUs;
+  sleep_ms(100);
+  ums = uptime_ms();
+  CHECK(g_hostAwuCount - awu == 2, "sleep_ms(100): %ld AWU wake-ups", (long) (g_hostAwuCount - awu));
+  CHECK((g_millisHigh == 0x1235) && (g_millis == 89), "sleep_ms(100): millis 0x%04X.%08lX", (int) g_millisHigh, (unsigned long) g_millis);
+  CHECK(ums == ((0x1235ULL << 32) | 89), "sleep_ms(100): uptime_ms() 0x%llX", (unsigned long long) ums);
+  CHECK(g_micros == g_millis * 1000UL, "sleep_ms(100): micros %lu inconsistent with millis", (unsigned long) g_micros);
+  CHECK(micros() - us == 100000UL, "sleep_ms(100): micros() advanced %ld us", (long) (micros() - us));
+  CHECK((uint32_t) uptime_us() == micros(), "sleep_ms(100): uptime_us() inconsistent with micros()");
+  CHECK(g_hostTimeUs - ref == 100000ULL, "sleep_ms(100): took %lld us", (long long) (g_hostTimeUs - ref));
+
+  ////////
+  // accuracy vs. reference clock. SW clock advances by requested time, real duration depends on LSI error during AWU
+  ////////
+  for (j = 0; j < sizeof(lsiError)/sizeof(lsiError[0]); j++)
+  {
+    g_hostLsiErrorPpm = lsiError[j];
+    init_SW_clock();
+    printf("# sleep_ms() error at LSI %+ld ppm [ms:us]:", (long) lsiError[j]);
+    for (i = 0; i < sizeof(duration)/sizeof(duration[0]); i++)
+    {
+      host_tim4_step(37 * (i + 1));                       // different sub-ms phase
+      us  = micros();
+      awu = g_hostAwuCount;
+      ref = g_hostTimeUs;
+      sleep_ms(duration[i]);
+      err = (int64_t) (g_hostTimeUs - ref) - (int64_t) duration[i] * 1000;
+      printf(" %ld:%+lld", (long) duration[i], (long long) err);
+
+      // SW clock advanced by requested time. AWU only used for long sleeps
+      CHECK(micros() - us == duration[i] * 1000UL, "sleep_ms(%ld): micros() advanced %ld us", (long) duration[i], (long) (micros() - us));
+      CHECK((g_hostAwuCount != awu) == (duration[i] >= SW_CLOCK_AWU_MIN), "sleep_ms(%ld): %ld AWU wake-ups",
+        (long) duration[i], (long) (g_hostAwuCount - awu));
+
+      // real duration: exact w/o AWU or LSI error, else error is max. LSI error
+      if ((lsiError[j] == 0) || (duration[i] < SW_CLOCK_AWU_MIN))
+        CHECK(err == 0, "sleep_ms(%ld): error %lld us", (long) duration[i], (long long) err);
+      else
+        CHECK((err * lsiError[j] > 0) && (llabs(err) <= (int64_t) duration[i] * llabs(lsiError[j]) / 1000),
+          "sleep_ms(%ld): error %lld us at LSI %+ld ppm", (long) duration[i], (long long) err, (long) lsiError[j]);
+    }
+    printf("\n");
+  }
+  g_hostLsiErrorPpm = 0;
+
+} // test_sleep()
+
+
+
+/////////////////
+// SW timer callback (ISR mode). Store time of expiry
+/////////////////
+static void timer_fired(void *Ctx)
+{
+  test_fired_t  *fired = (test_fired_t*) Ctx;
+
+  if (fired->count < sizeof(fired->ref)/sizeof(fired->ref[0]))
+  {
+    fired->ref[fired->count] = g_hostTimeUs;
+    fired->ms[fired->count]  = g_millis;
+  }
+  fired->count++;
+
+} // timer_fired()
+
+
+
+/////////////////
+// scheduler task. Not executed, because scheduler_dispatch() is not called during sleep
+/////////////////
+static void task_dummy(void)
+{
+} // task_dummy()
+
+
+
+/////////////////
+// test tickless sleep_ms() with pending SW timers and scheduler task
+/////////////////
+static void test_sleep_timer(void)
+{
+  static sw_timer_t     timerOnce, timerPeriodic;
+  static test_fired_t   firedOnce, firedPeriodic;
+  static sched_task_t   task[] = { { task_dummy, 300, 49, 100 } };     // released at 50, 350, 650, 950ms
+  uint32_t              ms, us, awu, tim4;
+  uint64_t              ref;
+  uint8_t               i;
+
+  // SW clock starts at sub-ms phase 0, i.e. tick n is at n*1ms
+  init_SW_clock();
+  sw_timer_init();
+  scheduler_init(task, 1);
+  memset(&firedOnce, 0, sizeof(firedOnce));
+  memset(&firedPeriodic, 0, sizeof(firedPeriodic));
+  sw_timer_setup(&timerOnce, timer_fired, &firedOnce, SW_TIMER_ISR);
+  sw_timer_setup(&timerPeriodic, timer_fired, &firedPeriodic, SW_TIMER_ISR);
+  sw_timer_start(&timerOnce, 250, 0);
+  sw_timer_start(&timerPeriodic, 100, 100);
+  CHECK(sw_timer_next_expiry() == 100, "tickless: next expiry %lu ms", (unsigned long) sw_timer_next_expiry());
+  CHECK(scheduler_next_release() == 50, "tickless: next release %lu ms", (unsigned long) scheduler_next_release());
+
+  // sleep with pending timers
+  ms   = millis();
+  us   = micros();
+  ref  = g_hostTimeUs;
+  awu  = g_hostAwuCount;
+  tim4 = g_hostTim4Count;
+  sleep_ms(TEST_SLEEP_MS);
+  printf("# tickless sleep_ms(%d): %ld AWU wake-ups, %ld TIM4 interrupts\n", TEST_SLEEP_MS,
+    (long) (g_hostAwuCount - awu), (long) (g_hostTim4Count - tim4));
+
+  // SW clock advanced by sleep time. Most ticks were skipped in active-halt
+  CHECK(millis() - ms == TEST_SLEEP_MS, "tickless: millis() advanced %ld ms", (long) (millis() - ms));
+  CHECK(micros() - us == TEST_SLEEP_MS * 1000UL, "tickless: micros() advanced %ld us", (long) (micros() - us));
+  CHECK(g_hostTimeUs - ref == TEST_SLEEP_MS * 1000ULL, "tickless: took %lld us", (long long) (g_hostTimeUs - ref));
+  CHECK(g_hostAwuCount != awu, "tickless: no AWU wake-up");
+  CHECK(g_hostTim4Count - tim4 < TEST_SLEEP_MS / 4, "tickless: %ld TIM4 interrupts", (long) (g_hostTim4Count - tim4));
+
+  // one-shot timer fired once on time
+  CHECK(firedOnce.count == 1, "tickless: one-shot fired %d times", (int) firedOnce.count);
+  CHECK((firedOnce.ref[0] - ref == 250000ULL) && (firedOnce.ms[0] - ms == 250),
+    "tickless: one-shot fired at %lld us / %ld ms", (long long) (firedOnce.ref[0] - ref), (long) (firedOnce.ms[0] - ms));
+  CHECK(sw_timer_running(&timerOnce) == FALSE, "tickless: one-shot still running");
+
+  // periodic timer fired on time w/o drift
+  CHECK(firedPeriodic.count == TEST_SLEEP_MS/100, "tickless: periodic fired %d times", (int) firedPeriodic.count);
+  for (i = 0; (i < firedPeriodic.count) && (i < TEST_SLEEP_MS/100); i++)
+    CHECK((firedPeriodic.ref[i] - ref == (i + 1) * 100000ULL) && (firedPeriodic.ms[i] - ms == (i + 1) * 100UL),
+      "tickless: periodic fired #%d at %lld us / %ld ms", (int) i, (long long) (firedPeriodic.ref[i] - ref), (long) (firedPeriodic.ms[i] - ms));
+
+  // wheel caught up, i.e. next expiry is relative to current time
+  CHECK(sw_timer_next_expiry() == 100, "tickless: next expiry %lu ms after sleep", (unsigned long) sw_timer_next_expiry());
+
+  // task released on time, each further release while pending is an overrun
+  CHECK(task[0].tRelease - us == 950000UL, "tickless: task released at %ld us", (long) (task[0].tRelease - us));
+  CHECK((task[0].pending == TRUE) && (task[0].overruns == 3), "tickless: task pending %d, %d overruns",
+    (int) task[0].pending, (int) task[0].overruns);
+  CHECK(scheduler_next_release() == 250, "tickless: next release %lu ms after sleep", (unsigned long) scheduler_next_release());
+
+  // no timers or tasks -> no limit for following tests
+  sw_timer_stop(&timerPeriodic);
+  scheduler_init(NULL, 0);
+  CHECK(sw_timer_next_expiry() == 0xFFFFFFFFUL, "tickless: timer running after stop");
+
+} // test_sleep_timer()
+
+
+
+/////////////////
+// test UART stdio with TX and RX ring buffer
+/////////////////
+static void test_uart(void)
+{
+  struct itimerval  timer = { { 0, 20 }, { 0, 20 } };
+  char              rx[4*TEST_UART_BUFFER+1];
+  uint32_t          count;
+  uint16_t          i, j, n;
+  int16_t           c;
+
+  host_uart_init();
+  signal(SIGALRM, uart_tx_isr);
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  ////////
+  // TX buffer
+  ////////
+
+  // fill buffer w/o ISR -> nothing sent yet, TXE interrupt is enabled
+  s_txIsrActive = 0;
+  for (i = 0; i < TEST_UART_BUFFER; i++)
+    putchar('a' + i);
+  CHECK(g_hostUartTxCount == 0, "TX: %ld bytes sent w/o ISR", (long) g_hostUartTxCount);
+  CHECK(g_hostUartTxeIT == TRUE, "TX: TXE interrupt not enabled");
+  CHECK(g_UART_TxHighWater == TEST_UART_BUFFER, "TX: high water %d", (int) g_UART_TxHighWater);
+
+  // overflow of full buffer. DROP: bytes are discarded. BLOCK: wait for ISR, i.e. enable it
+  #if (UART_TX_OVERFLOW == UART_TX_OVERFLOW_DROP)
+    for (i = 0; i < 3; i++)
+      putchar('X');
+    CHECK(g_UART_TxDropped == 3, "TX DROP: %d bytes dropped", (int) g_UART_TxDropped);
+    s_txIsrActive = 1;
+    uart_flush();
+    CHECK(g_hostUartTxCount == TEST_UART_BUFFER, "TX DROP: %ld bytes sent", (long) g_hostUartTxCount);
+  #else
+    s_txIsrActive = 1;
+    for (i = 0; i < 3; i++)
+      putchar('0' + i);
+    uart_flush();
+    CHECK(g_hostUartTxCount == TEST_UART_BUFFER+3, "TX BLOCK: %ld bytes sent", (long) g_hostUartTxCount);
+    CHECK(memcmp(&(g_hostUartTx[TEST_UART_BUFFER]), "012", 3) == 0, "TX BLOCK: data mismatch");
+  #endif
+  CHECK(memcmp(g_hostUartTx, "abcdefgh", TEST_UART_BUFFER) == 0, "TX: data mismatch");
+
+  // send >256 bytes via ISR -> buffer index and free running 8-bit head/tail wrap. No data lost
+  // For DROP wait for free buffer, i.e. no byte is discarded
+  count = g_hostUartTxCount;
+  for (i = 0; i < 600; i++)
+  {
+    #if (UART_TX_OVERFLOW == UART_TX_OVERFLOW_DROP)
+      while ((uint8_t) (g_UART_TxHead - g_UART_TxTail) >= TEST_UART_BUFFER);
+    #endif
+    putchar((uint8_t) i);
+  }
+  uart_flush();
+  CHECK(g_hostUartTxCount == count + 600, "TX wrap: %ld bytes sent", (long) (g_hostUartTxCount - count));
+  for (i = 0; i < 600; i++)
+  {
+    if (g_hostUartTx[(count + i) % HOST_UART_TX_SIZE] != (uint8_t) i)
+      break;
+  }
+  CHECK(i == 600, "TX wrap: data mismatch at byte %d", (int) i);
+  usleep(1000);
+  CHECK(g_hostUartTxeIT == FALSE, "TX: TXE interrupt not disabled by ISR when buffer is empty");
+
+  // stop TX ISR
+  s_txIsrActive = 0;
+  timer.it_value.tv_usec = timer.it_interval.tv_usec = 0;
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+
+  ////////
+  // RX buffer
+  ////////
+
+  // no data
+  CHECK(uart_available() == 0, "RX: %d bytes available w/o data", (int) uart_available());
+  CHECK(uart_read() == -1, "RX: uart_read() w/o data != -1");
+
+  // receive and read different sizes -> buffer index and free running 8-bit head/tail wrap
+  for (i = 0; i < 200; i++)
+  {
+    n = 1 + i % TEST_UART_BUFFER;
+    for (j = 0; j < n; j++)
+      rx[j] = 'A' + (i + j) % 26;
+    rx[n] = '\0';
+    uart_rx_isr(rx);
+    CHECK(uart_available() == n, "RX wrap: %d bytes available, expect %d", (int) uart_available(), (int) n);
+    for (j = 0; j < n; j++)
+    {
+      c = (j & 1) ? uart_read() : getchar();
+      CHECK(c == rx[j], "RX wrap: read %d, expect %d", (int) c, (int) rx[j]);
+    }
+    CHECK(uart_read() == -1, "RX wrap: uart_read() on empty buffer != -1");
+  }
+
+  // overflow: bytes beyond buffer size are dropped, buffered bytes are kept
+  for (j = 0; j < TEST_UART_BUFFER+4; j++)
+    rx[j] = '0' + j;
+  rx[TEST_UART_BUFFER+4] = '\0';
+  uart_rx_isr(rx);
+  CHECK(g_UART_RxDropped == 4, "RX overflow: %d bytes dropped", (int) g_UART_RxDropped);
+  CHECK(uart_available() == TEST_UART_BUFFER, "RX overflow: %d bytes available", (int) uart_available());
+  for (j = 0; j < TEST_UART_BUFFER; j++)
+    CHECK(uart_read() == rx[j], "RX overflow: data mismatch at byte %d", (int) j);
+  CHECK(uart_read() == -1, "RX overflow: uart_read() on empty buffer != -1");
+
+} // test_uart()
+
+
+
+/////////////////
+//  main routine
+/////////////////
+int main(void)
+{
+  printf("# host test: CRC16_CCITT_IMPL=%d, UART_TX_OVERFLOW=%s\n", (int) CRC16_CCITT_IMPL,
+    (UART_TX_OVERFLOW == UART_TX_OVERFLOW_DROP) ? "DROP" : "BLOCK");
+
+  // run tests
+  test_crc16();
+  test_fletcher16();
+  test_memory();
+  test_clock();
+  test_clock_wrap("wrap 2^32us", 0, 4294967UL - TEST_WRAP_MS, 0);
+  test_clock_wrap("wrap 2^32us pending", 0, 4294967UL - TEST_WRAP_MS, 1);
+  test_clock_wrap("wrap 2^32ms", 0, 0xFFFFFFFFUL - TEST_WRAP_MS + 1, 0);
+  test_clock_wrap("wrap 2^32ms pending", 0, 0xFFFFFFFFUL - TEST_WRAP_MS + 1, 1);
+  test_clock_wrap("wrap 2^48ms", 0xFFFF, 0xFFFFFFFFUL - TEST_WRAP_MS + 1, 0);
+  test_clock_wrap("wrap 2^48ms pending", 0xFFFF, 0xFFFFFFFFUL - TEST_WRAP_MS + 1, 1);
+  test_sleep();
+  test_sleep_timer();
+  test_uart();
+
+  // print result. Return error for "make test"
+  printf("# %ld checks, %ld failed\n", (long) s_checks, (long) s_errors);
+
+  return (s_errors == 0) ? 0 : 1;
+
+} // main()
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,403 @@
+/**
+  \file memory_access.c
+
+  \author G. Icking-Konert
+
+  \brief implementation of memory read/write routines
+
+  implementation of block read routines for 24-bit address range.
+  Compared to a loop over read_1B_far() the address setup is done only
+  once per block, which speeds up e.g. checksum calculation over flash.
+
+  For SDCC (no far pointers) also contains the 24-bit read/write routines.
+  These only use registers and stack, i.e. they are reentrant and may
+  also be used in interrupts
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "memory_access.h"
+
+
+/*----------------------------------------------------------
+    MODULE MACROS
+----------------------------------------------------------*/
+
+#if defined(__SDCC)
+
+  // stack offset of 1st parameter in below naked routines (= size of return address + 1)
+  #ifdef __SDCC_MODEL_LARGE
+    #define MEM_ARG     4
+  #else
+    #define MEM_ARG     3
+  #endif
+
+#endif // __SDCC
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+#if defined(__SDCC)
+
+/**
+  \fn void read_bank_far(uint16_t Offset, uint8_t *Buf, uint16_t Len, uint8_t Bank)
+
+  \brief copy data block within one 64kB bank to RAM
+
+  \param[in]  Offset  16-bit offset within bank
+  \param[out] Buf     RAM buffer to copy to
+  \param[in]  Len     number of bytes to copy (>0, Offset+Len <= 0x10000)
+  \param[in]  Bank    address bits 16..23 (0..2)
+
+  Copy a block from 24-bit address range to RAM. Bank is selected via the
+  extended offset of ldf, source offset (Y) and destination pointer (X) are
+  kept in registers. The end pointer is stored in the parameter on stack
+*/
+static void read_bank_far(uint16_t Offset, uint8_t *Buf, uint16_t Len, uint8_t Bank) MEMORY_STACKCALL __naked
+{
+  __asm
+    ; store end of destination buffer in parameter Len
+    ldw   x,(MEM_ARG+2,sp)
+    addw  x,(MEM_ARG+4,sp)
+    ldw   (MEM_ARG+4,sp),x
+
+    ; X = destination pointer, Y = source offset
+    ldw   x,(MEM_ARG+2,sp)
+    ldw   y,(MEM_ARG+0,sp)
+
+    ; select loop for bank
+    ld    a,(MEM_ARG+6,sp)
+    jreq  00010$
+    dec   a
+    jreq  00020$
+
+    ; bank 2 (0x20000-0x2FFFF)
+  00030$:
+    ldf   a,(0x020000,y)
+    ld    (x),a
+    incw  x
+    incw  y
+    cpw   x,(MEM_ARG+4,sp)
+    jrne  00030$
+    jra   00099$
+
+    ; bank 1 (0x10000-0x1FFFF)
+  00020$:
+    ldf   a,(0x010000,y)
+    ld    (x),a
+    incw  x
+    incw  y
+    cpw   x,(MEM_ARG+4,sp)
+    jrne  00020$
+    jra   00099$
+
+    ; bank 0 (0x0000-0xFFFF) -> 16-bit access
+  00010$:
+    ld    a,(y)
+    ld    (x),a
+    incw  x
+    incw  y
+    cpw   x,(MEM_ARG+4,sp)
+    jrne  00010$
+
+  00099$:
+#ifdef __SDCC_MODEL_LARGE
+    retf
+#else
+    ret
+#endif
+  __endasm;
+
+} // read_bank_far()
+
+#endif // __SDCC
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+#if defined(__SDCC)
+
+/**
+  \fn uint8_t read_1B_far(uint32_t addr)
+
+  \brief read 1 byte from memory
+
+  \param[in] addr  address to read from (<0x30000)
+
+  \return 1B data read from memory
+
+  Read 1B from memory. Required for SDCC and >64kB due to lack of far pointers.
+  Bank is selected via the extended offset of ldf, i.e. only registers and stack
+  are used (reentrant)
+*/
+uint8_t read_1B_far(uint32_t addr) MEMORY_STACKCALL __naked
+{
+  __asm
+    ; X = address bits 0..15, A = address bits 16..23
+    ldw   x,(MEM_ARG+2,sp)
+    ld    a,(MEM_ARG+1,sp)
+    jreq  00010$
+    dec   a
+    jreq  00020$
+
+    ; bank 2 (0x20000-0x2FFFF)
+    ldf   a,(0x020000,x)
+    jra   00099$
+
+    ; bank 1 (0x10000-0x1FFFF)
+  00020$:
+    ldf   a,(0x010000,x)
+    jra   00099$
+
+    ; bank 0 (0x0000-0xFFFF) -> 16-bit access
+  00010$:
+    ld    a,(x)
+
+    ; return value in A
+  00099$:
+#ifdef __SDCC_MODEL_LARGE
+    retf
+#else
+    ret
+#endif
+  __endasm;
+
+} // read_1B_far
+
+
+
+/**
+  \fn uint16_t read_2B_far(uint32_t addr)
+
+  \brief read 2 bytes from memory
+
+  \param[in] addr  address to read from (<0x30000)
+
+  \return 2B data read from memory (big endian)
+
+  Read 2B from memory via read_1B_far(). Reentrant, but not atomic
+*/
+uint16_t read_2B_far(uint32_t addr)
+{
+  return (((uint16_t) read_1B_far(addr)) << 8) | read_1B_far(addr+1);
+
+} // read_2B_far
+
+
+
+/**
+  \fn uint32_t read_4B_far(uint32_t addr)
+
+  \brief read 4 bytes from memory
+
+  \param[in] addr  address to read from (<0x30000)
+
+  \return 4B data read from memory (big endian)
+
+  Read 4B from memory via read_2B_far(). Reentrant, but not atomic
+*/
+uint32_t read_4B_far(uint32_t addr)
+{
+  return (((uint32_t) read_2B_far(addr)) << 16) | read_2B_far(addr+2);
+
+} // read_4B_far
+
+
+
+/**
+  \fn void write_1B_far(uint32_t addr, uint8_t val)
+
+  \brief write 1 byte to memory
+
+  \param[in] addr  address to write to (<0x30000)
+  \param[in] val   data to write
+
+  Write 1B to memory. Required for SDCC and >64kB due to lack of far pointers.
+  Bank is selected via the extended offset of ldf, i.e. only registers and stack
+  are used (reentrant)
+*/
+void write_1B_far(uint32_t addr, uint8_t val) MEMORY_STACKCALL __naked
+{
+  __asm
+    ; X = address bits 0..15, A = address bits 16..23
+    ldw   x,(MEM_ARG+2,sp)
+    ld    a,(MEM_ARG+1,sp)
+    jreq  00010$
+    dec   a
+    jreq  00020$
+
+    ; bank 2 (0x20000-0x2FFFF)
+    ld    a,(MEM_ARG+4,sp)
+    ldf   (0x020000,x),a
+    jra   00099$
+
+    ; bank 1 (0x10000-0x1FFFF)
+  00020$:
+    ld    a,(MEM_ARG+4,sp)
+    ldf   (0x010000,x),a
+    jra   00099$
+
+    ; bank 0 (0x0000-0xFFFF) -> 16-bit access
+  00010$:
+    ld    a,(MEM_ARG+4,sp)
+    ld    (x),a
+
+  00099$:
+#ifdef __SDCC_MODEL_LARGE
+    retf
+#else
+    ret
+#endif
+  __endasm;
+
+} // write_1B_far
+
+
+
+/**
+  \fn void write_2B_far(uint32_t addr, uint16_t val)
+
+  \brief write 2 bytes to memory
+
+  \param[in] addr  address to write to (<0x30000)
+  \param[in] val   data to write (big endian)
+
+  Write 2B to memory via write_1B_far(). Reentrant, but not atomic
+*/
+void write_2B_far(uint32_t addr, uint16_t val)
+{
+  write_1B_far(addr,   (uint8_t) (val >> 8));
+  write_1B_far(addr+1, (uint8_t) val);
+
+} // write_2B_far
+
+
+
+/**
+  \fn void write_4B_far(uint32_t addr, uint32_t val)
+
+  \brief write 4 bytes to memory
+
+  \param[in] addr  address to write to (<0x30000)
+  \param[in] val   data to write (big endian)
+
+  Write 4B to memory via write_2B_far(). Reentrant, but not atomic
+*/
+void write_4B_far(uint32_t addr, uint32_t val)
+{
+  write_2B_far(addr,   (uint16_t) (val >> 16));
+  write_2B_far(addr+2, (uint16_t) val);
+
+} // write_4B_far
+
+#endif // __SDCC
+
+
+
+/**
+  \fn void read_block_far(uint32_t Addr, uint8_t *Buf, uint16_t Len)
+
+  \brief copy data block from memory to RAM
+
+  \param[in]  Addr  24-bit address to read from
+  \param[out] Buf   RAM buffer to copy to
+  \param[in]  Len   number of bytes to copy
+
+  Copy a block from 24-bit address range to RAM.
+  For Cosmic & IAR use far pointers. For SDCC the block is split at 64kB bank
+  boundaries and copied via read_bank_far(), which keeps source offset and
+  destination pointer in registers (reentrant). Other compilers use read_1B_far()
+*/
+void read_block_far(uint32_t Addr, uint8_t *Buf, uint16_t Len)
+{
+#if defined(__CSMC__)
+
+  const @far uint8_t  *src = (const @far uint8_t*) Addr;
+
+  while (Len--)
+    *Buf++ = *src++;
+
+#elif defined(__ICCSTM8__)
+
+  const uint8_t __far *src = (const uint8_t __far*) Addr;
+
+  while (Len--)
+    *Buf++ = *src++;
+
+#elif defined(__SDCC)
+
+  uint32_t  remain;
+  uint16_t  len;
+
+  while (Len)
+  {
+    // number of bytes until end of bank
+    remain = 0x10000 - (Addr & 0xFFFF);
+    len = (Len < remain) ? Len : (uint16_t) remain;
+
+    // copy part within bank
+    read_bank_far((uint16_t) Addr, Buf, len, (uint8_t) (Addr >> 16));
+    Addr += len;
+    Buf  += len;
+    Len  -= len;
+
+  } // while (Len)
+
+#else // other compilers, e.g. host build with mock "stm8s.h"
+
+  while (Len--)
+    *Buf++ = read_1B_far(Addr++);
+
+#endif // __SDCC
+
+} // read_block_far()
+
+
+
+/**
+  \fn void read_range_far(uint32_t AddrStart, uint32_t AddrEnd, memory_chunk_cb_t Callback, void *Ctx)
+
+  \brief read memory range in chunks and pass them to a callback
+
+  \param[in]  AddrStart   first address (inclusive)
+  \param[in]  AddrEnd     last address (inclusive)
+  \param[in]  Callback    function called for each chunk
+  \param[in]  Ctx         user context passed to callback, e.g. checksum value
+
+  Read address range in chunks of MEMORY_CHUNK_SIZE bytes via read_block_far() into
+  a local buffer (on stack) and call Callback(Ctx, buffer, length) for each chunk.
+*/
+void read_range_far(uint32_t AddrStart, uint32_t AddrEnd, memory_chunk_cb_t Callback, void *Ctx)
+{
+  uint8_t   buf[MEMORY_CHUNK_SIZE];
+  uint32_t  addr = AddrStart;
+  uint32_t  remain;
+  uint8_t   len;
+
+  while (addr <= AddrEnd)
+  {
+    // number of bytes in next chunk
+    remain = AddrEnd - addr;
+    len = (remain < MEMORY_CHUNK_SIZE) ? (uint8_t) (remain + 1) : MEMORY_CHUNK_SIZE;
+
+    // copy chunk to RAM and pass to callback
+    read_block_far(addr, buf, len);
+    Callback(Ctx, buf, len);
+
+    // avoid endless loop for AddrEnd=0xFFFFFFFF
+    if ((addr + len) < addr)
+      break;
+    addr += len;
+
+  } // while (addr <= AddrEnd)
+
+} // read_range_far()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
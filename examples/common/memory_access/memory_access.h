@@ -7,7 +7,12 @@
    
   declaration of memory read and write routines.
   Access to >16b address range (= P-flash above 32kB due to flash starts @ 0x8000)
-  requires far pointers (Cosmic & IAR) or helper routines (SDCC) 
+  requires far pointers (Cosmic & IAR) or reentrant helper routines (SDCC, see memory_access.c).
+  For larger blocks use read_block_far() or read_range_far() (see memory_access.c)
+  Note: read_2B_far() and read_4B_far() (and for SDCC write_2B_far() and write_4B_far()) are composed
+  of single byte accesses, i.e. they are not atomic. An ISR writing the same address meanwhile can cause
+  a mixed old/new value. If required, disable interrupts around such accesses.
+  For an ISR preemption stress test under ucsim see "../../benchmark" (BENCH_MEMORY_STRESS)
 */
 
 /*-----------------------------------------------------------------------------
@@ -80,245 +85,77 @@
   #define write_4B(addr,val)  *((uint32_t*) (addr)) = val               /**< write 1B to 16-bit address */
 
   /////////
-  // read & write data from memory (24-bit address). SDCC doesn't support far pointers -> use inline assembly
+  // read & write data from memory (24-bit address). SDCC doesn't support far pointers -> use assembler routines in memory_access.c.
+  // These only use registers and stack, i.e. are reentrant and may also be used in interrupts
   /////////
-    
-  // global variables for interfacing with SDCC assembler
-  #if defined(_MAIN_)
-    volatile uint32_t          mem_address_tmp;     ///< address for interfacing to below assembler
-    volatile uint32_t          mem_value_tmp;       ///< data for r/w via below assembler
-  #else // _MAIN_
-    extern volatile uint32_t   mem_address_tmp;
-    extern volatile uint32_t   mem_value_tmp;
-  #endif // _MAIN_
-
-
-  /**
-    \fn uint8_t read_1B_far(uint32_t addr)
-  
-    \brief read 1 byte from memory (inline)
-     
-    \param[in] addr  address to read from
-
-    \return 1B data read from memory
-
-    Inline function to read 1B from memory. 
-    Required for SDCC and >64kB due to lack of far pointers
-  */
-  inline uint8_t read_1B_far(uint32_t addr)
-  {    
-    // pass data between C and assembler via global variables
-    extern volatile uint32_t mem_address_tmp;
-    extern volatile uint8_t  mem_value_tmp;       // use lowest 8bit of 32bit variable
-
-    // set address
-    mem_address_tmp = addr;
-      
-    // use inline assembler for actual read
-    __asm
-      push a 
-      ldf  a,[_mem_address_tmp+1].e
-      ld   _mem_value_tmp, a
-      pop  a
-    __endasm;
-
-    // return data
-    return(mem_value_tmp);
-
-  } // read_1B_far
-
-
-  /**
-    \fn uint16_t read_2B_far(uint32_t addr)
-
-    \brief read 2 bytes from memory (inline)
-      
-    \param[in] addr  address to read from
-
-    \return 2B data read from memory
-
-    Inline function to read 2B from memory. 
-    Required for SDCC and >64kB due to lack of far pointers
-  */
-  inline uint16_t read_2B_far(uint32_t addr)
-  {    
-    // pass data between C and assembler via global variables
-    extern volatile uint32_t mem_address_tmp;
-    extern volatile uint16_t mem_value_tmp;       // use lowest 16bit of 32bit variable
-
-    // set address
-    mem_address_tmp = addr;
-      
-    // use inline assembler for actual read
-    __asm
-      push a 
-      ldf  a,[_mem_address_tmp+1].e
-      ld   _mem_value_tmp,a
-      ldw  x,#1
-      ldf  a,([_mem_address_tmp+1].e,x)
-      ld   _mem_value_tmp+1,a
-      pop  a
-    __endasm;
-
-    // return data
-    return(mem_value_tmp);
-
-  } // read_2B_far
-  
 
-  /**
-    \fn uint16_t read_4B_far(uint32_t addr)
-  
-    \brief read 4 bytes from memory (inline)
-      
-    \param[in] addr  address to read from
-
-    \return 4B data read from memory
-
-    Inline function to read 4B from memory. 
-    Required for SDCC and >64kB due to lack of far pointers
-  */
-  inline uint32_t read_4B_far(uint32_t addr)
-  {
-    // pass data between C and assembler via global variables
-    extern volatile uint32_t mem_address_tmp;
-    extern volatile uint32_t mem_value_tmp;
-
-    // set address
-    mem_address_tmp = addr;
-      
-    // use inline assembler for actual read
-    __asm
-      push a
-      ldf  a,[_mem_address_tmp+1].e
-      ld   _mem_value_tmp,a
-      ldw  x,#1
-      ldf  a,([_mem_address_tmp+1].e,x)
-      ld  _mem_value_tmp+1,a
-      ldw  x,#2
-      ldf  a,([_mem_address_tmp+1].e,x)
-      ld   _mem_value_tmp+2,a
-      ldw  x,#3
-      ldf  a,([_mem_address_tmp+1].e,x)
-      ld   _mem_value_tmp+3,a
-      pop  a
-    __endasm;
-
-    // return data
-    return(mem_value_tmp);
-
-  } // read_4B_far
-  
+  // naked assembler routines expect parameters on stack. SDCC >=4.1.12 passes parameters in registers by default
+  #if ((__SDCC_VERSION_MAJOR*10000 + __SDCC_VERSION_MINOR*100 + __SDCC_VERSION_PATCH) >= 40112)
+    #define MEMORY_STACKCALL  __sdcccall(0)
+  #else
+    #define MEMORY_STACKCALL
+  #endif
 
-  /**
-    \fn void write_1B_far(uint32_t addr, uint8_t val)
-  
-    \brief write 1 byte to memory (inline)
-      
-    \param[in] addr  address to read from
-    \param[in] val   data to write
-
-    Inline function to write 1B to memory. 
-    Required for SDCC and >64kB due to lack of far pointers
-  */
-  inline void write_1B_far(uint32_t addr, uint8_t val)
-  {
-    // pass data between C and assembler via global variables
-    extern volatile uint32_t mem_address_tmp;
-    extern volatile uint8_t  mem_value_tmp;       // use lowest 8bit of 32bit variable
-    
-    // set address & value
-    mem_address_tmp = addr;
-    mem_value_tmp  = val;
-      
-    // use inline assembler for actual write
-    __asm
-      push a
-      ld   a,_mem_value_tmp
-      ldf  [_mem_address_tmp+1].e,a
-      pop  a
-    __endasm;
-
-  } // write_1B_far
-
-    
-  /**
-    \fn void write_2B_far(uint32_t addr, uint16_t val)
-  
-    \brief write 2 bytes to memory (inline)
-      
-    \param[in] addr  address to read from
-    \param[in] val   data to write
-
-    Inline function to write 2B to memory. 
-    Required for SDCC and >64kB due to lack of far pointers
-  */
-  inline void write_2B_far(uint32_t addr, uint16_t val)
-  {    
-    // pass data between C and assembler via global variables
-    extern volatile uint32_t mem_address_tmp;
-    extern volatile uint16_t  mem_value_tmp;        // use lowest 16bit of 32bit variable
-      
-    // set address & value
-    mem_address_tmp = addr;
-    mem_value_tmp  = val;
-     
-    // use inline assembler for actual write
-    __asm
-      push a
-      ld   a,_mem_value_tmp
-      ldf  [_mem_address_tmp+1].e,a
-      ld   a,_mem_value_tmp+1
-      ldw  x,#1
-      ldf  ([_mem_address_tmp+1].e,x),a
-      pop  a
-    __endasm;
-
-  } // write_2B_far
-  
+  /// @brief read 1B from 24-bit address
+  uint8_t   read_1B_far(uint32_t addr) MEMORY_STACKCALL;
 
-  /**
-    \fn void write_2B_far(uint32_t addr, uint32_t val)
-  
-    \brief write 4 bytes to memory (inline)
-      
-    \param[in] addr  address to read from
-    \param[in] val   data to write
-
-    Inline function to write 4B to memory. 
-    Required for SDCC and >64kB due to lack of far pointers
-  */
-  inline void write_4B_far(uint32_t addr, uint32_t val)
-  {
-    // pass data between C and assembler via global variables
-    extern volatile uint32_t mem_address_tmp;
-    extern volatile uint32_t mem_value_tmp;
-
-    // set address & value
-    mem_address_tmp = addr;
-    mem_value_tmp  = val;
-      
-    // use inline assembler for actual write
-    __asm
-      push a
-      ld   a,_mem_value_tmp
-      ldf  [_mem_address_tmp+1].e,a
-      ld   a,_mem_value_tmp+1
-      ldw  x,#1
-      ldf  ([_mem_address_tmp+1].e,x),a
-      ld   a,_mem_value_tmp+2
-      ldw  x,#2
-      ldf  ([_mem_address_tmp+1].e,x),a
-      ld   a,_mem_value_tmp+3
-      ldw  x,#3
-      ldf  ([_mem_address_tmp+1].e,x),a
-      pop  a
-    __endasm;
-
-  } // write_4B_far
+  /// @brief read 2B from 24-bit address (big endian). Composed of 1B reads, i.e. not atomic
+  uint16_t  read_2B_far(uint32_t addr);
+
+  /// @brief read 4B from 24-bit address (big endian). Composed of 1B reads, i.e. not atomic
+  uint32_t  read_4B_far(uint32_t addr);
+
+  /// @brief write 1B to 24-bit address
+  void      write_1B_far(uint32_t addr, uint8_t val) MEMORY_STACKCALL;
+
+  /// @brief write 2B to 24-bit address (big endian). Composed of 1B writes, i.e. not atomic
+  void      write_2B_far(uint32_t addr, uint16_t val);
+
+  /// @brief write 4B to 24-bit address (big endian). Composed of 1B writes, i.e. not atomic
+  void      write_4B_far(uint32_t addr, uint32_t val);
+
+
+///////
+// other compilers, e.g. host build. Read/write macros are provided by mock "stm8s.h" (see common/host)
+///////
+#else
+
+  #include "stm8s.h"
 
 #endif // __SDCC
 
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// size of RAM buffer (on stack) for read_range_far() [B]
+#if !defined(MEMORY_CHUNK_SIZE)
+  #define MEMORY_CHUNK_SIZE     64
+#endif
+#if (MEMORY_CHUNK_SIZE < 1) || (MEMORY_CHUNK_SIZE > 255)
+  #error MEMORY_CHUNK_SIZE must be in range 1..255
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// callback for read_range_far(). Called with user context, RAM buffer and number of bytes for each chunk
+typedef void (*memory_chunk_cb_t)(void *Ctx, const uint8_t *Buf, uint8_t Len);
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief copy data block from 24-bit address to RAM
+void read_block_far(uint32_t Addr, uint8_t *Buf, uint16_t Len);
+
+/// @brief read 24-bit address range in chunks of MEMORY_CHUNK_SIZE and pass them to a callback
+void read_range_far(uint32_t AddrStart, uint32_t AddrEnd, memory_chunk_cb_t Callback, void *Ctx);
+
 /*-----------------------------------------------------------------------------
     END OF MODULE DEFINITION FOR MULTIPLE INLUSION
 -----------------------------------------------------------------------------*/
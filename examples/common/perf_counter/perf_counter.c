@@ -0,0 +1,144 @@
+/**********************
+  implementation of cycle-accurate profiling counter using timer TIM2
+
+  TIM2 runs free at fMASTER (prescaler 1) and is extended to 32 bits in its overflow ISR.
+  Code sections are measured via PERF_BEGIN(id)/PERF_END(id). Number of calls and
+  min/max/total cycles per id are accumulated in a static table, which can be
+  printed via perf_print(). Without PERF_ENABLE the macros are empty, i.e. have no overhead
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "stdio.h"
+#include "perf_counter.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void perf_init(void)
+
+  \brief init cycle counter
+
+  Init 16-bit timer TIM2 as free-running counter at fMASTER with overflow interrupt.
+  Measure overhead of an empty measurement, which is subtracted from all results.
+  Then clear statistics. Call with interrupts enabled.
+*/
+void perf_init(void)
+{
+  uint8_t   i;
+  uint32_t  dt;
+
+  // config free-running counter 0..0xFFFF at fMASTER
+  g_perfHigh = 0;
+  TIM2_DeInit();
+  TIM2_TimeBaseInit(TIM2_PRESCALER_1, 0xFFFF);
+  TIM2_ClearFlag(TIM2_FLAG_UPDATE);
+  TIM2_ITConfig(TIM2_IT_UPDATE, ENABLE);
+  TIM2_Cmd(ENABLE);
+
+  // measure overhead of empty PERF_BEGIN()/PERF_END(). Use min. of several runs to skip interrupts
+  g_perfOverhead = 0xFFFF;
+  for (i = 0; i < 8; i++)
+  {
+    g_perfTable[0].start = perf_cycles();
+    dt = perf_cycles() - g_perfTable[0].start;
+    if (dt < g_perfOverhead)
+      g_perfOverhead = (uint16_t) dt;
+  }
+
+  // reset statistics
+  perf_clear();
+
+} // perf_init()
+
+
+
+/**
+  \fn void perf_clear(void)
+
+  \brief clear statistics
+
+  Reset number of measurements, min/max and total cycles of all ids.
+*/
+void perf_clear(void)
+{
+  uint8_t   i;
+
+  for (i = 0; i < PERF_NUM_IDS; i++)
+  {
+    g_perfTable[i].count = 0;
+    g_perfTable[i].min   = 0xFFFFFFFF;
+    g_perfTable[i].max   = 0;
+    g_perfTable[i].total = 0;
+  }
+
+} // perf_clear()
+
+
+
+/**
+  \fn void perf_stop(uint8_t Id, uint32_t End)
+
+  \brief update statistics of measurement
+
+  \param[in]  Id    measurement id (0..PERF_NUM_IDS-1)
+  \param[in]  End   cycle counter at end of measurement
+
+  Calculate duration since PERF_BEGIN(Id) minus overhead and update statistics.
+  Is called via PERF_END(Id). Not reentrant for the same Id.
+*/
+void perf_stop(uint8_t Id, uint32_t End)
+{
+  perf_entry_t  *entry = &(g_perfTable[Id]);
+  uint32_t      dt;
+
+  // duration corrected for measurement overhead
+  dt = End - entry->start;
+  dt = (dt > g_perfOverhead) ? (dt - g_perfOverhead) : 0;
+
+  // update statistics. Total saturates
+  entry->count++;
+  if (dt < entry->min)
+    entry->min = dt;
+  if (dt > entry->max)
+    entry->max = dt;
+  if ((entry->total + dt) < entry->total)
+    entry->total = 0xFFFFFFFF;
+  else
+    entry->total += dt;
+
+} // perf_stop()
+
+
+
+/**
+  \fn void perf_print(void)
+
+  \brief print statistics
+
+  Print statistics of all ids with at least one measurement via printf().
+  Output is tab separated with one line per id, all times are in cycles.
+*/
+void perf_print(void)
+{
+  perf_entry_t  *entry = g_perfTable;
+  uint8_t       i;
+
+  printf("id\tcount\tmin\tmax\tavg\ttotal\n");
+  for (i = 0; i < PERF_NUM_IDS; i++, entry++)
+  {
+    if (entry->count == 0)
+      continue;
+    printf("%d\t%ld\t%ld\t%ld\t%ld\t%ld\n", (int) i, (long) entry->count, (long) entry->min,
+      (long) entry->max, (long) (entry->total / entry->count), (long) entry->total);
+  }
+
+} // perf_print()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,168 @@
+/**********************
+  declaration of cycle-accurate profiling counter using timer TIM2
+
+  TIM2 runs free at fMASTER (prescaler 1) and is extended to 32 bits in its overflow ISR.
+  Code sections are measured via PERF_BEGIN(id)/PERF_END(id). Number of calls and
+  min/max/total cycles per id are accumulated in a static table, which can be
+  printed via perf_print(). Without PERF_ENABLE the macros are empty, i.e. have no overhead
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PERF_COUNTER_H_
+#define _PERF_COUNTER_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// number of measurement ids, i.e. size of statistics table
+#if !defined(PERF_NUM_IDS)
+  #define PERF_NUM_IDS    8
+#endif
+#if (PERF_NUM_IDS < 1) || (PERF_NUM_IDS > 255)
+  #error PERF_NUM_IDS must be in range 1..255
+#endif
+
+/// start/stop measurement of code section. Id is in range 0..PERF_NUM_IDS-1. Nesting is only supported for different ids
+#if defined(PERF_ENABLE)
+  #define PERF_BEGIN(id)  g_perfTable[id].start = perf_cycles()
+  #define PERF_END(id)    perf_stop(id, perf_cycles())
+#else
+  #define PERF_BEGIN(id)
+  #define PERF_END(id)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// statistics of one measurement id. Times are in cycles of fMASTER, corrected for measurement overhead
+typedef struct
+{
+  uint32_t            start;        ///< cycle counter at PERF_BEGIN()
+  uint32_t            count;        ///< number of measurements
+  uint32_t            min;          ///< min. duration [cycles]
+  uint32_t            max;          ///< max. duration [cycles]
+  uint32_t            total;        ///< sum of durations [cycles]. Saturates at 2^32-1 (~268s @ 16MHz)
+
+} perf_entry_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint16_t         g_perfHigh = 0;                 ///< bits 16..31 of cycle counter. Increased in TIM2 ISR
+  uint16_t                  g_perfOverhead = 0;             ///< cycles of empty PERF_BEGIN()/PERF_END(). Measured in perf_init()
+  perf_entry_t              g_perfTable[PERF_NUM_IDS];      ///< statistics per measurement id
+#else // _MAIN_
+  extern volatile uint16_t  g_perfHigh;
+  extern uint16_t           g_perfOverhead;
+  extern perf_entry_t       g_perfTable[PERF_NUM_IDS];
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief start TIM2 as free-running cycle counter, measure overhead and clear statistics
+void perf_init(void);
+
+/// @brief clear statistics of all ids
+void perf_clear(void);
+
+/// @brief update statistics of id with end time [cycles]. Called via PERF_END()
+void perf_stop(uint8_t Id, uint32_t End);
+
+/// @brief print statistics of all used ids via printf()
+void perf_print(void);
+
+
+/**
+  \fn uint32_t perf_cycles(void)
+
+  \brief get 32-bit cycle counter
+
+  \return cycles of fMASTER since perf_init(). Overruns every ~268s @ 16MHz
+
+  Lock-free read of TIM2 counter and software extension g_perfHigh, see micros() for details.
+  Reading TIM2_CNTRH latches TIM2_CNTRL, i.e. the 16-bit counter is read consistently.
+  Inline implementation for minimal overhead.
+*/
+#if defined(__CSMC__)
+  @inline uint32_t perf_cycles(void)
+#else // SDCC & IAR
+  static inline uint32_t perf_cycles(void)
+#endif
+{
+  uint16_t  high;
+  uint16_t  cnt;
+  uint8_t   ovf;
+
+  do
+  {
+    // copy upper 16 bits from global variable
+    high = g_perfHigh;
+    ovf  = 0;
+
+    // get TIM2 counter. MSB first to latch LSB
+    cnt  = ((uint16_t) TIM2->CNTRH) << 8;
+    cnt |= TIM2->CNTRL;
+
+    // account for TIM2 overflow not yet handled by ISR (e.g. interrupts disabled). Then re-read counter after overflow
+    if (TIM2->SR1 & TIM2_SR1_UIF)
+    {
+      cnt  = ((uint16_t) TIM2->CNTRH) << 8;
+      cnt |= TIM2->CNTRL;
+      ovf  = 1;
+    }
+
+  } while (high != g_perfHigh);   // TIM2 ISR changed g_perfHigh (or torn read) -> repeat
+
+  // return combined counter
+  return ((((uint32_t) high) + ovf) << 16) | cnt;
+
+} // perf_cycles()
+
+
+
+/**
+  \fn void ISR_TIM2_handler(void)
+
+  \brief inline overflow handler for TIM2
+
+  TIM2 overflow handler. Is called from within actual TIM2 ISR in stm8s_it.c.
+  Inline implementation for minimal latency.
+*/
+#if defined(__CSMC__)
+  @inline void ISR_TIM2_handler(void)
+#else // SDCC & IAR
+  static inline void ISR_TIM2_handler(void)
+#endif
+{
+  // clear timer 2 interrupt flag
+  TIM2->SR1 = (uint8_t) (~TIM2_SR1_UIF);
+
+  // extend counter to 32 bit
+  g_perfHigh++;
+
+} // ISR_TIM2_handler
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _PERF_COUNTER_H_
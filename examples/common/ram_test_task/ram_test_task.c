@@ -0,0 +1,294 @@
+/**********************
+  implementation of transparent incremental run-time RAM test.
+
+  Test RAM in small blocks, e.g. one block per 1ms scheduler tick. Each block is
+  saved to a module buffer, tested with March C- and restored, all with interrupts
+  disabled and without any stack access (see ram_test_block()). Therefore also the
+  block containing the active stack and the module buffer itself are tested.
+  The test context (next block, statistics) is kept between calls.
+  SDCC only, because the block test is implemented in assembler.
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "ram_test_task.h"
+#include "sw_clock.h"
+
+
+/*----------------------------------------------------------
+    MODULE VARIABLES
+----------------------------------------------------------*/
+
+// start of block to test. Read by ram_test_block()
+static volatile uint16_t    s_block;
+
+// address for saving block content, or 0 if block lies within s_buf. Read by ram_test_block()
+static volatile uint16_t    s_save;
+
+// save buffer. Content is only valid during ram_test_block(), i.e. it can be tested like any other RAM.
+// Size 2x block, because an aligned block overlaps at most one half, unless it lies completely within s_buf
+static uint8_t              s_buf[2*RAM_TEST_BLOCK];
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint8_t ram_test_block(void)
+
+  \brief save, test and restore one RAM block
+
+  \return 0 if block is ok, else 1
+
+  Test RAM block at s_block (RAM_TEST_BLOCK bytes, aligned) with March C-:
+  up(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); up(r0).
+  Before the test the block is copied to s_save, afterwards (also on error) it is
+  copied back. Interrupts are disabled meanwhile.
+  Only registers are used between saving and restoring, i.e. the stack (incl. the
+  saved CC and the return address of this routine) may lie within the tested block.
+  The end of a block is detected by the address alignment, i.e. the block must not
+  cross a 256B boundary.
+  Runtime is ~59 cycles per byte, see RAM_TEST_BLOCK_CYCLES
+*/
+static uint8_t ram_test_block(void) __naked
+{
+  __asm
+    ; disable interrupts. CC is pushed before block is saved, i.e. it is also restored
+    push  cc
+    sim
+
+    ; X = block start, Y = save buffer. Skip save if block lies within save buffer
+    ldw   x,_s_block
+    ldw   y,_s_save
+    jreq  00010$
+
+    ; save block to buffer
+  00001$:
+    ld    a,(x)
+    ld    (y),a
+    incw  x
+    incw  y
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00001$
+    subw  x,#RAM_TEST_BLOCK
+    subw  y,#RAM_TEST_BLOCK
+
+    ;;;;;;;;;;;;
+    ; TEST ONLY: provoke RAM error in each block -> check error handling
+    ;;;;;;;;;;;;
+    ;;;jra 00090$
+
+    ; M0: up(w0)
+  00010$:
+    clr   (x)
+    incw  x
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00010$
+    subw  x,#RAM_TEST_BLOCK
+
+    ; M1: up(r0,w1)
+  00011$:
+    tnz   (x)
+    jrne  00090$
+    cpl   (x)
+    incw  x
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00011$
+    subw  x,#RAM_TEST_BLOCK
+
+    ; M2: up(r1,w0). CPL reads 0xFF and writes 0x00 -> Z flag is set if ok
+  00012$:
+    cpl   (x)
+    jrne  00090$
+    incw  x
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00012$
+
+    ; M3: down(r0,w1). X starts at block end+1
+  00013$:
+    decw  x
+    tnz   (x)
+    jrne  00090$
+    cpl   (x)
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00013$
+    addw  x,#RAM_TEST_BLOCK
+
+    ; M4: down(r1,w0)
+  00014$:
+    decw  x
+    cpl   (x)
+    jrne  00090$
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00014$
+
+    ; M5: up(r0)
+  00015$:
+    tnz   (x)
+    jrne  00090$
+    incw  x
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00015$
+    subw  x,#RAM_TEST_BLOCK
+
+    ; block ok -> C=0
+    rcf
+    jra   00020$
+
+    ; RAM error -> C=1. Align X to block start for restore
+  00090$:
+    ld    a,xl
+    and   a,#0x100-RAM_TEST_BLOCK
+    ld    xl,a
+    scf
+
+    ; restore block from buffer (if saved). Loop doesn't change C
+  00020$:
+    tnzw  y
+    jreq  00022$
+  00021$:
+    ld    a,(y)
+    ld    (x),a
+    incw  x
+    incw  y
+    ld    a,xl
+    and   a,#RAM_TEST_BLOCK-1
+    jrne  00021$
+
+    ; return C (0=ok, 1=error) in A and restore interrupt state
+  00022$:
+    clr   a
+    rlc   a
+    pop   cc
+#ifdef __SDCC_MODEL_LARGE
+    retf
+#else
+    ret
+#endif
+  __endasm;
+
+} // ram_test_block()
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void ram_test_task_init(ram_test_task_t *Ctx, uint16_t AddrStart, uint16_t AddrEnd)
+
+  \brief initialize run-time RAM test
+
+  \param[out] Ctx         test context
+  \param[in]  AddrStart   first RAM address (inclusive)
+  \param[in]  AddrEnd     last RAM address (inclusive)
+
+  Initialize context for run-time RAM test over address range. Range is extended
+  to RAM_TEST_BLOCK boundaries, e.g. 0x0000..RAM_END.
+  Requires SW clock to be running, see sw_clock.h
+*/
+void ram_test_task_init(ram_test_task_t *Ctx, uint16_t AddrStart, uint16_t AddrEnd)
+{
+  // store block aligned range
+  Ctx->addrStart = AddrStart & ~(RAM_TEST_BLOCK-1);
+  Ctx->addrEnd   = AddrEnd | (RAM_TEST_BLOCK-1);
+
+  // no completed pass yet
+  Ctx->duration  = 0;
+  Ctx->passes    = 0;
+  Ctx->tBlockMax = 0;
+  Ctx->errorAddr = 0;
+
+  // start first pass
+  Ctx->addr      = Ctx->addrStart;
+  Ctx->tPass     = millis();
+
+} // ram_test_task_init()
+
+
+
+/**
+  \fn ram_test_result_t ram_test_task_run(ram_test_task_t *Ctx, uint8_t NumBlocks)
+
+  \brief test next RAM blocks
+
+  \param[in,out] Ctx        test context
+  \param[in]     NumBlocks  number of blocks to test in this call
+
+  \return RAM_TEST_PASS if a pass was completed, RAM_TEST_ERROR on RAM error, else RAM_TEST_BUSY
+
+  Test next NumBlocks blocks of RAM_TEST_BLOCK bytes transparently, see ram_test_block().
+  Interrupts are disabled only per block, for RAM_TEST_BLOCK_CYCLES. The max. time per
+  block (incl. interrupts) is measured in Ctx->tBlockMax.
+  After a completed pass the pass duration (= full coverage period) is stored in the context,
+  and the next pass is started automatically.
+  On RAM error the test stops and the block start is stored in Ctx->errorAddr. The same block
+  is tested again with the next call. The error reaction (e.g. SW reset) depends on the application.
+*/
+ram_test_result_t ram_test_task_run(ram_test_task_t *Ctx, uint8_t NumBlocks)
+{
+  uint16_t  buf = (uint16_t) s_buf;
+  uint32_t  tStart;
+  uint16_t  dt;
+  uint8_t   err;
+
+  while (NumBlocks--)
+  {
+    // select save buffer: none if block lies within s_buf, else the half of s_buf not overlapping the block
+    if ((Ctx->addr >= buf) && (Ctx->addr + RAM_TEST_BLOCK <= buf + 2*RAM_TEST_BLOCK))
+      s_save = 0;
+    else if ((Ctx->addr < buf + RAM_TEST_BLOCK) && (Ctx->addr + RAM_TEST_BLOCK > buf))
+      s_save = buf + RAM_TEST_BLOCK;
+    else
+      s_save = buf;
+
+    // test block and measure time
+    tStart = micros();
+    s_block = Ctx->addr;
+    err = ram_test_block();
+    dt = (uint16_t) (micros() - tStart);
+    if (dt > Ctx->tBlockMax)
+      Ctx->tBlockMax = dt;
+
+    // RAM error -> stop test
+    if (err)
+    {
+      Ctx->errorAddr = Ctx->addr;
+      return RAM_TEST_ERROR;
+    }
+
+    // next block
+    Ctx->addr += RAM_TEST_BLOCK;
+
+    // pass finished -> store statistics and restart
+    if ((Ctx->addr > Ctx->addrEnd) || (Ctx->addr == 0x0000))
+    {
+      Ctx->duration = millis() - Ctx->tPass;
+      Ctx->passes++;
+
+      // start next pass
+      Ctx->addr  = Ctx->addrStart;
+      Ctx->tPass = millis();
+
+      return RAM_TEST_PASS;
+
+    } // pass finished
+
+  } // while (NumBlocks)
+
+  return RAM_TEST_BUSY;
+
+} // ram_test_task_run()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,89 @@
+/**********************
+  declaration of transparent incremental run-time RAM test.
+
+  Test RAM in small blocks, e.g. one block per 1ms scheduler tick. Each block is
+  saved to a module buffer, tested with March C- and restored, all with interrupts
+  disabled and without any stack access (see ram_test_task.c). Therefore also the
+  block containing the active stack and the module buffer itself are tested.
+  The test context (next block, statistics) is kept between calls.
+  SDCC only, because the block test is implemented in assembler.
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _RAM_TEST_TASK_H_
+#define _RAM_TEST_TASK_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+#if !defined(__SDCC)
+  #error run-time RAM test is only implemented for SDCC
+#endif
+
+/// size of tested RAM block [B]. Must be a power of 2 (block must not cross a 256B boundary). Module buffer is 2x this size
+#if !defined(RAM_TEST_BLOCK)
+  #define RAM_TEST_BLOCK          16
+#endif
+#if (RAM_TEST_BLOCK < 2) || (RAM_TEST_BLOCK > 128) || ((RAM_TEST_BLOCK & (RAM_TEST_BLOCK-1)) != 0)
+  #error RAM_TEST_BLOCK must be a power of 2 in range 2..128
+#endif
+
+/// calculated CPU cycles per block with interrupts disabled (save 8, March C- 43, restore 8 cycles/B + overhead)
+#define RAM_TEST_BLOCK_CYCLES     (59 * RAM_TEST_BLOCK + 30)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// result of ram_test_task_run()
+typedef enum
+{
+  RAM_TEST_BUSY  = 0,               ///< blocks tested ok, pass not yet completed
+  RAM_TEST_PASS  = 1,               ///< blocks tested ok and pass over complete range completed
+  RAM_TEST_ERROR = 2                ///< RAM error detected, see errorAddr
+
+} ram_test_result_t;
+
+
+/// context of run-time RAM test
+typedef struct
+{
+  uint16_t          addrStart;      ///< first address of range (inclusive, block aligned)
+  uint16_t          addrEnd;        ///< last address of range (inclusive, block aligned)
+  uint16_t          addr;           ///< start of next block to test
+  uint32_t          tPass;          ///< start time of current pass [ms]
+  uint32_t          duration;       ///< duration of last completed pass [ms] (= full coverage period)
+  uint16_t          passes;         ///< number of completed passes
+  uint16_t          tBlockMax;      ///< max. measured time for single block incl. call overhead [us]
+  uint16_t          errorAddr;      ///< start of last block with RAM error
+
+} ram_test_task_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief initialize run-time RAM test over address range
+void ram_test_task_init(ram_test_task_t *Ctx, uint16_t AddrStart, uint16_t AddrEnd);
+
+/// @brief test next RAM blocks. Return test result
+ram_test_result_t ram_test_task_run(ram_test_task_t *Ctx, uint8_t NumBlocks);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _RAM_TEST_TASK_H_
@@ -0,0 +1,235 @@
+/**********************
+  implementation of cooperative task scheduler based on SW clock
+
+  Tasks are defined in a static table with period, offset and runtime budget.
+  Tasks are released in the 1ms TIM4 ISR via ISR_scheduler_tick() and executed
+  in the main loop via scheduler_dispatch() in table order (= priority).
+  For each task overruns, start jitter and max. execution time are measured
+  with micros() from sw_clock.h
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "scheduler.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void scheduler_init(sched_task_t *Tasks, uint8_t NumTasks)
+
+  \brief initialize scheduler
+
+  \param[in,out] Tasks      static task table. Only func, period, offset and budget need to be set
+  \param[in]     NumTasks   number of tasks in table
+
+  Initialize task states and statistics, and activate task table.
+  Tasks are released every 'period' ms, starting 'offset'+1 ms after this call.
+  A period of 0 is set to 1ms, because the countdown in ISR_scheduler_tick() would
+  otherwise wrap and release the task only every 65.5s.
+  Requires SW clock to be running and ISR_scheduler_tick() being called from TIM4 ISR.
+  If SW_CLOCK_TICKLESS is defined, the scheduler is registered for sleep_ms() via sleep_register()
+*/
+void scheduler_init(sched_task_t *Tasks, uint8_t NumTasks)
+{
+  uint8_t   i;
+
+  // disable TIM4 interrupt to avoid race condition with ISR_scheduler_tick()
+  uint8_t oldTIM4_IER = TIM4->IER;
+  TIM4->IER &= ~TIM4_IT_UPDATE;
+
+  // initialize task states
+  for (i = 0; i < NumTasks; i++)
+  {
+    // period 0 would wrap countdown -> release every tick instead
+    if (Tasks[i].period == 0)
+      Tasks[i].period = 1;
+
+    Tasks[i].pending   = FALSE;
+    Tasks[i].countdown = Tasks[i].offset + 1;
+    Tasks[i].tRelease  = 0;
+  }
+
+  // activate task table
+  g_schedTasks    = Tasks;
+  g_schedNumTasks = NumTasks;
+
+  // reset statistics
+  scheduler_clear_stats();
+
+  // restore original TIM4 interrupt state
+  TIM4->IER = oldTIM4_IER;
+
+  // limit active-halt in sleep_ms() to next release and catch up skipped ticks
+  #if defined(SW_CLOCK_TICKLESS)
+    sleep_register(scheduler_next_release, scheduler_advance);
+  #endif
+
+} // scheduler_init()
+
+
+
+/**
+  \fn void scheduler_dispatch(void)
+
+  \brief execute released tasks
+
+  Execute all released tasks once in table order and update statistics.
+  Call from main loop as often as possible.
+*/
+void scheduler_dispatch(void)
+{
+  sched_task_t  *task = g_schedTasks;
+  uint32_t      tRelease, tStart, tEnd, dt;
+  uint8_t       oldTIM4_IER;
+  uint8_t       i;
+
+  for (i = 0; i < g_schedNumTasks; i++, task++)
+  {
+    // task not released
+    if (task->pending == FALSE)
+      continue;
+
+    // get release time and clear pending flag. Disable TIM4 interrupt to avoid race condition with ISR_scheduler_tick()
+    oldTIM4_IER = TIM4->IER;
+    TIM4->IER &= ~TIM4_IT_UPDATE;
+    tRelease = task->tRelease;
+    task->pending = FALSE;
+    TIM4->IER = oldTIM4_IER;
+
+    // execute task
+    tStart = micros();
+    (task->func)();
+    tEnd = micros();
+
+    // update start jitter
+    task->runs++;
+    dt = tStart - tRelease;
+    if (dt > 0xFFFF)
+      dt = 0xFFFF;
+    if ((uint16_t) dt > task->jitterMax)
+      task->jitterMax = (uint16_t) dt;
+
+    // update execution time
+    dt = tEnd - tStart;
+    if (dt > 0xFFFF)
+      dt = 0xFFFF;
+    if ((uint16_t) dt > task->execMax)
+      task->execMax = (uint16_t) dt;
+    if ((uint16_t) dt > task->budget)
+      task->budgetMiss++;
+
+    // task finished after next release -> deadline missed. Overrun counter is also changed in ISR
+    if ((tEnd - tRelease) > 1000L * (uint32_t) task->period)
+    {
+      oldTIM4_IER = TIM4->IER;
+      TIM4->IER &= ~TIM4_IT_UPDATE;
+      task->overruns++;
+      TIM4->IER = oldTIM4_IER;
+    }
+
+  } // loop over tasks
+
+} // scheduler_dispatch()
+
+
+
+/**
+  \fn uint32_t scheduler_next_release(void)
+
+  \brief get ticks until next task release
+
+  \return ticks [ms] until next release of any task (>=1), or 0xFFFFFFFF if no task is defined
+
+  Is used by sleep_ms() to limit active-halt
+*/
+uint32_t scheduler_next_release(void)
+{
+  sched_task_t  *task = g_schedTasks;
+  uint32_t      next = 0xFFFFFFFF;
+  uint8_t       i, oldTIM4_IER;
+
+  // disable TIM4 interrupt to avoid race condition with ISR_scheduler_tick()
+  oldTIM4_IER = TIM4->IER;
+  TIM4->IER &= ~TIM4_IT_UPDATE;
+
+  for (i = 0; i < g_schedNumTasks; i++, task++)
+  {
+    if (task->countdown < next)
+      next = task->countdown;
+  }
+
+  // restore original TIM4 interrupt state
+  TIM4->IER = oldTIM4_IER;
+
+  return next;
+
+} // scheduler_next_release()
+
+
+
+/**
+  \fn void scheduler_advance(uint32_t Ticks)
+
+  \brief catch up ticks skipped in active-halt
+
+  \param[in] Ticks    number of skipped ticks [ms]
+
+  Decrease countdown of all tasks by 'Ticks'. No task is released, because sleep_ms()
+  limits 'Ticks' to less than scheduler_next_release(). Tasks which would have been
+  released meanwhile are released on the next tick instead.
+  Is called by sleep_ms() after wake-up from active-halt with TIM4 interrupt disabled
+*/
+void scheduler_advance(uint32_t Ticks)
+{
+  sched_task_t  *task = g_schedTasks;
+  uint8_t       i;
+
+  for (i = 0; i < g_schedNumTasks; i++, task++)
+  {
+    if (task->countdown > Ticks)
+      task->countdown -= (uint16_t) Ticks;
+    else
+      task->countdown = 1;
+  }
+
+} // scheduler_advance()
+
+
+
+/**
+  \fn void scheduler_clear_stats(void)
+
+  \brief reset statistics of all tasks
+
+  Reset execution counter, overruns, budget misses, max. jitter and max. execution time of all tasks.
+*/
+void scheduler_clear_stats(void)
+{
+  sched_task_t  *task = g_schedTasks;
+  uint8_t       i;
+
+  // disable TIM4 interrupt to avoid race condition with ISR_scheduler_tick()
+  uint8_t oldTIM4_IER = TIM4->IER;
+  TIM4->IER &= ~TIM4_IT_UPDATE;
+
+  for (i = 0; i < g_schedNumTasks; i++, task++)
+  {
+    task->runs       = 0;
+    task->overruns   = 0;
+    task->budgetMiss = 0;
+    task->jitterMax  = 0;
+    task->execMax    = 0;
+  }
+
+  // restore original TIM4 interrupt state
+  TIM4->IER = oldTIM4_IER;
+
+} // scheduler_clear_stats()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
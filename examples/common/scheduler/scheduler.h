@@ -0,0 +1,138 @@
+/**********************
+  declaration of cooperative task scheduler based on SW clock
+
+  Tasks are defined in a static table with period, offset and runtime budget.
+  Tasks are released in the 1ms TIM4 ISR via ISR_scheduler_tick() and executed
+  in the main loop via scheduler_dispatch() in table order (= priority).
+  For each task overruns, start jitter and max. execution time are measured
+  with micros() from sw_clock.h.
+  With SW_CLOCK_TICKLESS, sleep_ms() halts until the tick before the next release 
+  and catches up the skipped ticks via scheduler_advance()
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+#include "sw_clock.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// task function. Must return within its budget (cooperative)
+typedef void (*sched_func_t)(void);
+
+
+/// task descriptor. Only configuration is set by user, other members are initialized by scheduler_init()
+typedef struct
+{
+  // configuration
+  sched_func_t        func;         ///< task function
+  uint16_t            period;       ///< task period [ms]. 0 is set to 1 by scheduler_init()
+  uint16_t            offset;       ///< delay of first release [ms], e.g. to distribute tasks with same period
+  uint16_t            budget;       ///< worst-case execution time [us]
+
+  // state. Changed in ISR_scheduler_tick()
+  volatile bool       pending;      ///< task released, but not yet executed
+  volatile uint16_t   countdown;    ///< ticks until next release
+  volatile uint32_t   tRelease;     ///< time of last release [us]
+
+  // statistics. Changed in scheduler_dispatch()
+  uint32_t            runs;         ///< number of executions
+  uint16_t            overruns;     ///< number of missed deadlines, i.e. task was released again before being executed or finished
+  uint16_t            budgetMiss;   ///< number of executions exceeding budget
+  uint16_t            jitterMax;    ///< max. delay between release and start [us]
+  uint16_t            execMax;      ///< max. execution time [us]
+
+} sched_task_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  sched_task_t       *g_schedTasks = NULL;      ///< task table. Set via scheduler_init()
+  volatile uint8_t    g_schedNumTasks = 0;      ///< number of tasks in table
+#else // _MAIN_
+  extern sched_task_t      *g_schedTasks;
+  extern volatile uint8_t   g_schedNumTasks;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// initialize scheduler with static task table
+void scheduler_init(sched_task_t *Tasks, uint8_t NumTasks);
+
+/// execute released tasks. Call from main loop
+void scheduler_dispatch(void);
+
+/// reset statistics of all tasks
+void scheduler_clear_stats(void);
+
+/// get ticks [ms] until next task release, or 0xFFFFFFFF if no task is defined
+uint32_t scheduler_next_release(void);
+
+/// catch up ticks [ms] skipped in active-halt of sleep_ms(). Must be less than scheduler_next_release()
+void scheduler_advance(uint32_t Ticks);
+
+
+/**
+  \fn void ISR_scheduler_tick(void)
+
+  \brief inline 1ms tick handler for scheduler
+
+  Release tasks which are due. Is called from within actual TIM4 ISR in stm8s_it.c
+  after ISR_TIM4_handler(), i.e. g_micros is the time of this tick.
+  If a task is released while still pending, an overrun is counted.
+  Inline implementation for minimal latency.
+*/
+#if defined(__CSMC__)
+  @inline void ISR_scheduler_tick(void)
+#else // SDCC & IAR
+  static inline void ISR_scheduler_tick(void)
+#endif
+{
+  sched_task_t  *task = g_schedTasks;
+  uint8_t       i;
+
+  for (i = 0; i < g_schedNumTasks; i++, task++)
+  {
+    // task is due
+    if (--(task->countdown) == 0)
+    {
+      task->countdown = task->period;
+
+      // previous release not executed yet -> deadline missed
+      if (task->pending)
+        task->overruns++;
+
+      // release task
+      task->tRelease = g_micros;
+      task->pending  = TRUE;
+
+    } // task due
+
+  } // loop over tasks
+
+} // ISR_scheduler_tick
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _SCHEDULER_H_
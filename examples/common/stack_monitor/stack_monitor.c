@@ -0,0 +1,147 @@
+/**********************
+  implementation of stack painting and high-water mark monitor.
+
+  At start of main() the unused stack is filled with a pattern. Then the stack is
+  scanned in small steps, e.g. from a scheduler task, for the lowest overwritten
+  address (= high-water mark). A write access to the guard band at the bottom of
+  the stack indicates a stack overflow and triggers a SW reset (see sw_reset.h).
+  Note: stack bytes overwritten with the pattern value are not detected as used
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "stack_monitor.h"
+#include "sw_reset.h"
+
+
+/*----------------------------------------------------------
+    MODULE MACROS
+----------------------------------------------------------*/
+
+// distance [B] between painted area and local variable of stack_paint(), for remaining stack frame
+#define STACK_PAINT_MARGIN    16
+
+// first address above guard band
+#define STACK_SCAN_START      (STACK_BOTTOM + STACK_GUARD)
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void stack_paint(void)
+
+  \brief fill unused stack with pattern
+
+  Fill stack from STACK_BOTTOM up to current stack frame with STACK_PATTERN.
+  The current stack pointer is approximated by the address of a local variable,
+  and STACK_PAINT_MARGIN bytes below are kept for the remaining stack frame.
+  Call at start of main(), i.e. after startup code and RAM test, and before
+  interrupts are enabled.
+*/
+void stack_paint(void)
+{
+  volatile uint8_t  *p = (uint8_t*) STACK_BOTTOM;
+  uint16_t          end;
+
+  // end of painting below current stack frame
+  end = (uint16_t) &p - STACK_PAINT_MARGIN;
+
+  // fill unused stack
+  while ((uint16_t) p < end)
+    *(p++) = STACK_PATTERN;
+
+} // stack_paint()
+
+
+
+/**
+  \fn void stack_monitor_init(stack_monitor_t *Ctx)
+
+  \brief initialize stack monitor
+
+  \param[out] Ctx         monitor context
+
+  Initialize context for stack monitor. Stack must be painted before, see stack_paint().
+  High-water mark is available after first completed scan.
+*/
+void stack_monitor_init(stack_monitor_t *Ctx)
+{
+  // no used stack found yet
+  Ctx->lowest = STACK_TOP + 1;
+  Ctx->used   = 0;
+  Ctx->passes = 0;
+
+  // start first scan above guard band
+  Ctx->addr   = STACK_SCAN_START;
+
+} // stack_monitor_init()
+
+
+
+/**
+  \fn uint16_t stack_monitor_run(stack_monitor_t *Ctx, uint8_t NumBytes)
+
+  \brief check guard band and continue scan for high-water mark
+
+  \param[in,out] Ctx        monitor context
+  \param[in]     NumBytes   max. number of bytes to scan in this call
+
+  \return high-water mark, i.e. max. stack usage [B]
+
+  First check complete guard band of STACK_GUARD bytes. If it was written, the
+  stack has overflown and a SW reset via illegal opcode is triggered.
+  Then continue scan above guard band for max. NumBytes bytes, up to the lowest
+  used address found so far. The first non-pattern byte is the new lowest used
+  address. As stack usage only grows, a scan is then restarted from the bottom.
+*/
+uint16_t stack_monitor_run(stack_monitor_t *Ctx, uint8_t NumBytes)
+{
+  volatile uint8_t  *p;
+  uint8_t           i;
+
+  // check guard band. Stack overflow -> controlled reset before other RAM is corrupted
+  p = (uint8_t*) STACK_BOTTOM;
+  for (i = 0; i < STACK_GUARD; i++)
+  {
+    if (p[i] != STACK_PATTERN)
+      SW_RESET_ILLOP();
+  }
+
+  // continue scan for high-water mark
+  p = (uint8_t*) Ctx->addr;
+  while (NumBytes--)
+  {
+    // reached lowest used address -> scan completed, restart
+    if ((uint16_t) p >= Ctx->lowest)
+    {
+      p = (uint8_t*) STACK_SCAN_START;
+      Ctx->passes++;
+      break;
+    }
+
+    // found new lowest used address -> update high-water mark and restart
+    if (*p != STACK_PATTERN)
+    {
+      Ctx->lowest = (uint16_t) p;
+      Ctx->used   = STACK_TOP + 1 - Ctx->lowest;
+      p = (uint8_t*) STACK_SCAN_START;
+      break;
+    }
+
+    p++;
+
+  } // while (NumBytes)
+
+  // store next address to scan
+  Ctx->addr = (uint16_t) p;
+
+  return Ctx->used;
+
+} // stack_monitor_run()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
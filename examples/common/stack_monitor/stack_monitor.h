@@ -0,0 +1,92 @@
+/**********************
+  declaration of stack painting and high-water mark monitor.
+
+  At start of main() the unused stack is filled with a pattern. Then the stack is
+  scanned in small steps, e.g. from a scheduler task, for the lowest overwritten
+  address (= high-water mark). A write access to the guard band at the bottom of
+  the stack indicates a stack overflow and triggers a SW reset (see sw_reset.h).
+  Note: stack bytes overwritten with the pattern value are not detected as used
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _STACK_MONITOR_H_
+#define _STACK_MONITOR_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// last address of stack (= SP after reset). Default is RAM_END
+#if !defined(STACK_TOP)
+  #if defined(RAM_END)
+    #define STACK_TOP             RAM_END
+  #else
+    #error parameter STACK_TOP or RAM_END must be specified via project options or Makefile
+  #endif
+#endif
+
+/// size of RAM reserved for stack [B]. Must not overlap global variables, check linker map
+#if !defined(STACK_SIZE)
+  #define STACK_SIZE              256
+#endif
+
+/// size of guard band at bottom of stack [B]. Write access triggers SW reset
+#if !defined(STACK_GUARD)
+  #define STACK_GUARD             16
+#endif
+#if (STACK_GUARD < 1) || (STACK_GUARD > 255) || (STACK_GUARD >= STACK_SIZE)
+  #error STACK_GUARD must be in range 1..255 and smaller than STACK_SIZE
+#endif
+
+/// pattern of unused stack
+#if !defined(STACK_PATTERN)
+  #define STACK_PATTERN           0xA5
+#endif
+
+/// lowest address of stack, incl. guard band
+#define STACK_BOTTOM              (STACK_TOP + 1 - STACK_SIZE)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// context of stack monitor
+typedef struct
+{
+  uint16_t          addr;           ///< next address to scan
+  uint16_t          lowest;         ///< lowest used stack address found so far
+  uint16_t          used;           ///< high-water mark, i.e. max. stack usage [B]
+  uint16_t          passes;         ///< number of completed scans
+
+} stack_monitor_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief fill unused stack with STACK_PATTERN. Call at start of main()
+void stack_paint(void);
+
+/// @brief initialize stack monitor
+void stack_monitor_init(stack_monitor_t *Ctx);
+
+/// @brief check guard band and continue scan for given number of bytes. Return high-water mark [B]
+uint16_t stack_monitor_run(stack_monitor_t *Ctx, uint8_t NumBytes);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _STACK_MONITOR_H_
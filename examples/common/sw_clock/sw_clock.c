@@ -9,6 +9,124 @@
 #include "sw_clock.h"
 
 
+/*----------------------------------------------------------
+    MODULE VARIABLES
+----------------------------------------------------------*/
+
+#if defined(SW_CLOCK_TICKLESS)
+
+  // AWU timebases for active-halt, sorted by duration [ms]. Durations are nominal, i.e. accuracy depends on LSI
+  static const struct
+  {
+    uint16_t              ms;
+    AWU_Timebase_TypeDef  timebase;
+  } s_awuTimebase[] = {
+    {     1, AWU_TIMEBASE_1MS   },
+    {     2, AWU_TIMEBASE_2MS   },
+    {     4, AWU_TIMEBASE_4MS   },
+    {     8, AWU_TIMEBASE_8MS   },
+    {    16, AWU_TIMEBASE_16MS  },
+    {    32, AWU_TIMEBASE_32MS  },
+    {    64, AWU_TIMEBASE_64MS  },
+    {   128, AWU_TIMEBASE_128MS },
+    {   256, AWU_TIMEBASE_256MS },
+    {   512, AWU_TIMEBASE_512MS },
+    {  1000, AWU_TIMEBASE_1S    },
+    {  2000, AWU_TIMEBASE_2S    },
+    { 12000, AWU_TIMEBASE_12S   },
+    { 30000, AWU_TIMEBASE_30S   }
+  };
+  #define NUM_AWU_TIMEBASE    (sizeof(s_awuTimebase)/sizeof(s_awuTimebase[0]))
+
+  // modules which limit active-halt and catch up skipped ticks, see sleep_register()
+  static sleep_next_t     s_sleepNext[SW_CLOCK_SLEEP_HOOKS];
+  static sleep_advance_t  s_sleepAdvance[SW_CLOCK_SLEEP_HOOKS];
+  static uint8_t          s_numSleepHooks = 0;
+
+#endif // SW_CLOCK_TICKLESS
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+#if defined(SW_CLOCK_TICKLESS)
+
+/**
+  \fn bool sleep_awu(uint32_t ms)
+   
+  \brief sleep in active-halt with AWU wake-up
+  
+  \param[in]  ms   max. duration [ms] to sleep
+   
+  \return TRUE if active-halt was entered, FALSE if next event is too close
+   
+  Limit 'ms' to the tick before the next event of the registered modules (e.g. SW timer expiry),
+  which is then handled by a regular TIM4 tick. Enter active-halt for the longest AWU timebase 
+  <= 'ms' and <= SW_CLOCK_AWU_MAX. TIM4 is stopped in halt, i.e. the current sub-ms phase is kept. 
+  On AWU wake-up the SW clock and all registered modules are advanced by the nominal AWU duration.
+  If woken by another interrupt (e.g. EXTI) the halt duration is unknown, because the AWU counter
+  cannot be read. Then the SW clock is not corrected, i.e. it lags by up to the selected timebase.
+*/
+static bool sleep_awu(uint32_t ms)
+{
+  uint8_t   i, k, oldTIM4_IER;
+  uint32_t  oldMillis, next;
+
+  // limit to tick before next event of registered modules
+  oldMillis = g_millis;
+  for (k = 0; k < s_numSleepHooks; k++)
+  {
+    next = (s_sleepNext[k])();
+    if (next <= ms)
+      ms = (next > 0) ? next - 1 : 0;
+  }
+  if (ms < SW_CLOCK_AWU_MIN)
+    return FALSE;
+  if (ms > SW_CLOCK_AWU_MAX)
+    ms = SW_CLOCK_AWU_MAX;
+
+  // select longest AWU timebase <= ms
+  for (i = NUM_AWU_TIMEBASE-1; (i > 0) && (s_awuTimebase[i].ms > ms); i--);
+
+  // disable TIM4 interrupt until SW clock is advanced to avoid race condition with ISR_TIM4_handler().
+  // Abort if a tick occurred since the limit was calculated
+  oldTIM4_IER = TIM4->IER;
+  TIM4->IER &= ~TIM4_IT_UPDATE;
+  if ((g_millis != oldMillis) || SW_CLOCK_TIM4_OVF())
+  {
+    TIM4->IER = oldTIM4_IER;
+    return FALSE;
+  }
+
+  // enter active-halt until AWU (or other) interrupt. Note: halt enables interrupts
+  g_flagAWU = FALSE;
+  AWU_Init(s_awuTimebase[i].timebase);
+  halt();
+  AWU_Cmd(DISABLE);
+
+  // woken by AWU -> advance SW clock and registered modules by halt duration
+  if (g_flagAWU == TRUE)
+  {
+    g_millis += s_awuTimebase[i].ms;
+    if (g_millis < oldMillis)
+      g_millisHigh++;
+    g_micros += 1000L * (uint32_t) s_awuTimebase[i].ms;
+    g_flagMilli = TRUE;
+    for (k = 0; k < s_numSleepHooks; k++)
+      (s_sleepAdvance[k])(s_awuTimebase[i].ms);
+  }
+
+  // restore TIM4 interrupt
+  TIM4->IER = oldTIM4_IER;
+
+  return TRUE;
+
+} // sleep_awu()
+
+#endif // SW_CLOCK_TICKLESS
+
+
 /*----------------------------------------------------------
     FUNCTIONS
 ----------------------------------------------------------*/
@@ -24,12 +142,13 @@ void init_SW_clock(void)
 {
   // initialize global clock variables
   g_flagMilli = FALSE;
-  g_millis    = 0;
-  g_micros    = 0;
+  g_millis     = (uint32_t) (SW_CLOCK_START_MS);
+  g_millisHigh = 0;
+  g_micros     = (uint32_t) ((uint32_t) (SW_CLOCK_START_MS) * 1000L);    // consistent with g_millis (modulo 2^32)
   
   // config 1ms clock
   TIM4_DeInit();
-  TIM4_TimeBaseInit(TIM4_PRESCALER_64, 250);  // 16MHz/64 = 250kHz; Reload value = 250 -> 1ms overflow
+  TIM4_TimeBaseInit(TIM4_PRESCALER_64, 249);  // 16MHz/64 = 250kHz; counter 0..249 -> 250 steps = 1ms overflow
   TIM4_ClearFlag(TIM4_FLAG_UPDATE);
   TIM4_ITConfig(TIM4_IT_UPDATE, ENABLE);
   TIM4_Cmd(ENABLE);
@@ -47,19 +166,18 @@ void init_SW_clock(void)
 
   Get milliseconds from start of program with 1ms resolution. 
   Requires TIM4 to be initialized and running, and TIM4 interrupt being active.
-  Value overruns every ~49.7 days.
+  Value overruns every ~49.7 days, for longer durations use uptime_ms48() or uptime_ms().
+  Lock-free: repeat read if TIM4 ISR has changed g_millis meanwhile (torn read)
 */
 uint32_t millis()
 {
-  // store TIM4 interrupt state and disable it to avoid race condition with TIM4 ISR
-  uint8_t oldTIM4_IER = TIM4->IER;
-  TIM4->IER &= ~TIM4_IT_UPDATE;
+  uint32_t  ms;
 
   // copy millis from global variable
-  uint32_t ms = g_millis;
-
-  // restore original TIM4 TIM4 interrupt state
-  TIM4->IER = oldTIM4_IER;
+  do
+  {
+    ms = g_millis;
+  } while (ms != g_millis);
 
   // return current millis
   return(ms);
@@ -103,6 +221,201 @@ void delay(uint32_t ms)
 
 } // delay()
 
+
+
+/**
+  \fn void sleep_ms(uint32_t ms)
+   
+  \brief sleep for 'ms' in low power mode
+  
+  \param[in]  ms   duration[ms] to sleep
+   
+  Like delay(), but CPU is in wait mode (WFI) between TIM4 ticks instead of polling.
+  If SW_CLOCK_TICKLESS is defined, remaining times >= SW_CLOCK_AWU_MIN are spent in 
+  active-halt with AWU wake-up, where TIM4 is stopped and the SW clock is corrected on wake-up.
+  Active-halt ends 1 tick before the next event of modules registered via sleep_register(),
+  e.g. SW timer expiry or scheduler release. This tick and all ticks until the next active-halt 
+  are regular TIM4 interrupts in wait mode, i.e. ISR callbacks are called on time and
+  deferred callbacks and released tasks are handled after return.
+  Accuracy is then limited by the LSI (see datasheet, or calibrate via AWU_LSICalibrationConfig()).
+  Also peripherals are stopped in halt. Requires TIM4 to be initialized and running. 
+  Interrupts are enabled by WFI/halt.
+*/
+void sleep_ms(uint32_t ms)
+{
+  // get current TIM4 counter value
+  uint8_t   oldCntr = TIM4->CNTR;
+  uint32_t  start = millis();
+  uint32_t  elapsed;
+
+  // until full millis have passed
+  while ((elapsed = millis() - start) < ms)
+  {
+    // long remaining time -> active-halt with AWU wake-up, if next event is not too close
+    #if defined(SW_CLOCK_TICKLESS)
+      if (((ms - elapsed) >= SW_CLOCK_AWU_MIN) && (sleep_awu(ms - elapsed) == TRUE))
+        continue;
+    #endif
+
+    // wait mode until next TIM4 (or other) interrupt
+    wfi();
+  }
+
+  // wait for sub-ms remainder
+  while (TIM4->CNTR - oldCntr)
+    nop();
+
+} // sleep_ms()
+
+
+
+#if defined(SW_CLOCK_TICKLESS)
+
+/**
+  \fn bool sleep_register(sleep_next_t Next, sleep_advance_t Advance)
+   
+  \brief register module for tickless sleep
+  
+  \param[in]  Next      get ticks until next event of module
+  \param[in]  Advance   catch up ticks skipped in active-halt
+   
+  \return TRUE on success, FALSE if table is full (see SW_CLOCK_SLEEP_HOOKS)
+
+  Register a module with a 1ms tick in the TIM4 ISR (e.g. SW timer or scheduler) for sleep_ms(). 
+  Active-halt is limited to the tick before its next event, and skipped ticks are caught up
+  via 'Advance' after AWU wake-up. Registering the same module again has no effect
+*/
+bool sleep_register(sleep_next_t Next, sleep_advance_t Advance)
+{
+  uint8_t   i;
+
+  // already registered
+  for (i = 0; i < s_numSleepHooks; i++)
+  {
+    if (s_sleepNext[i] == Next)
+      return TRUE;
+  }
+
+  // table full
+  if (s_numSleepHooks >= SW_CLOCK_SLEEP_HOOKS)
+    return FALSE;
+
+  // add module
+  s_sleepNext[s_numSleepHooks]    = Next;
+  s_sleepAdvance[s_numSleepHooks] = Advance;
+  s_numSleepHooks++;
+
+  return TRUE;
+
+} // sleep_register()
+
+#endif // SW_CLOCK_TICKLESS
+
+
+
+
+/**
+  \fn void uptime_ms48(uint16_t *High, uint32_t *Low)
+   
+  \brief get 48-bit milliseconds since start of program
+  
+  \param[out]  High   bits 32..47 of ms counter
+  \param[out]  Low    bits 0..31 of ms counter (= millis())
+
+  Get 48-bit milliseconds from start of program with 1ms resolution, e.g. for compilers w/o 64-bit integers.
+  Value overruns every ~8900 years.
+  Lock-free: repeat read if TIM4 ISR has changed g_millis or g_millisHigh meanwhile
+*/
+void uptime_ms48(uint16_t *High, uint32_t *Low)
+{
+  uint16_t  hi;
+  uint32_t  lo;
+
+  // copy 48-bit millis from global variables
+  do
+  {
+    hi = g_millisHigh;
+    lo = g_millis;
+  } while ((lo != g_millis) || (hi != g_millisHigh));
+
+  // return result
+  *High = hi;
+  *Low  = lo;
+
+} // uptime_ms48()
+
+
+
+#if defined(SW_CLOCK_UPTIME64)
+
+/**
+  \fn uint64_t uptime_ms(void)
+   
+  \brief get 64-bit milliseconds since start of program
+  
+  \return milliseconds from start of program
+
+  Get milliseconds from start of program with 1ms resolution. Never overruns in practice (48-bit counter).
+  Requires 64-bit integer support.
+*/
+uint64_t uptime_ms(void)
+{
+  uint16_t  hi;
+  uint32_t  lo;
+
+  // get 48-bit millis
+  uptime_ms48(&hi, &lo);
+
+  // return combined result
+  return ((((uint64_t) hi) << 32) | lo);
+
+} // uptime_ms()
+
+
+
+/**
+  \fn uint64_t uptime_us(void)
+   
+  \brief get 64-bit microseconds since start of program. Resolution is 4us
+  
+  \return microseconds from start of program
+
+  Get microseconds from start of program with 4us resolution. Never overruns in practice (48-bit ms counter).
+  Requires 64-bit integer support. Lock-free, see micros() for details.
+*/
+uint64_t uptime_us(void)
+{
+  uint16_t  hi;
+  uint32_t  lo;
+  uint8_t   ovf;
+  uint8_t   cnt;
+
+  do
+  {
+    // copy 48-bit millis from global variables
+    hi  = g_millisHigh;
+    lo  = g_millis;
+    ovf = 0;
+
+    // get TIM4 counter (4us steps)
+    cnt = TIM4->CNTR;
+
+    // account for TIM4 overflow not yet handled by ISR (e.g. interrupts disabled). Then re-read counter after overflow
+    if (SW_CLOCK_TIM4_OVF())
+    {
+      cnt = TIM4->CNTR;
+      ovf = 1;
+    }
+
+  } while ((lo != g_millis) || (hi != g_millisHigh));   // TIM4 ISR changed counter (or torn read) -> repeat
+
+  // return combined result
+  return (((((uint64_t) hi) << 32) | lo) + ovf) * 1000 + 4 * (uint16_t) cnt;
+
+} // uptime_us()
+
+#endif // SW_CLOCK_UPTIME64
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
@@ -24,11 +24,19 @@
 #if defined(_MAIN_)
   volatile bool               g_flagMilli = FALSE;         ///< flag for 1ms timer interrupt. Set in TIM4 ISR
   volatile uint32_t           g_millis = 0;                ///< 1ms counter. Increased in TIM4 ISR
+  volatile uint16_t           g_millisHigh = 0;            ///< bits 32..47 of 48-bit ms counter. Increased in TIM4 ISR on overflow of g_millis
   volatile uint32_t           g_micros = 0;                ///< 1000us counter. Increased in TIM4 ISR
+  #if defined(SW_CLOCK_TICKLESS)
+    volatile bool             g_flagAWU = FALSE;           ///< flag for wake-up from active-halt by AWU. Set in AWU ISR
+  #endif
 #else // _MAIN_
   extern volatile bool        g_flagMilli;
   extern volatile uint32_t    g_millis;
+  extern volatile uint16_t    g_millisHigh;
   extern volatile uint32_t    g_micros;
+  #if defined(SW_CLOCK_TICKLESS)
+    extern volatile bool      g_flagAWU;
+  #endif
 #endif // _MAIN_
 
 
@@ -39,6 +47,63 @@
 #define flagMilli()           g_flagMilli                   ///< 1ms flag. Set in 1ms ISR
 #define clearFlagMilli()      g_flagMilli=FALSE             ///< clear 1ms flag
 
+/// start value of ms counter [ms], e.g. 0xFFFFF000 to test counter overflows. Default is 0
+#if !defined(SW_CLOCK_START_MS)
+  #define SW_CLOCK_START_MS   0
+#endif
+
+/// 64-bit uptime_ms() and uptime_us() require 64-bit integers (SDCC only). Else use uptime_ms48()
+#if defined(__SDCC)
+  #define SW_CLOCK_UPTIME64
+#endif
+
+/// sleep_ms(): use active-halt with AWU wake-up until the next event of modules registered via sleep_register().
+/// TIM4 is stopped in active-halt, but keeps its 1ms interrupt in the remaining wait mode (WFI) phases. Default is wait mode only
+//#define SW_CLOCK_TICKLESS
+
+/// min. remaining sleep time [ms] for active-halt, see sleep_ms(). Below use wait mode
+#if !defined(SW_CLOCK_AWU_MIN)
+  #define SW_CLOCK_AWU_MIN    16
+#endif
+#if (SW_CLOCK_AWU_MIN < 1)
+  #error SW_CLOCK_AWU_MIN must be >= 1
+#endif
+
+/// max. duration [ms] of a single active-halt. Bounds the time lost if halt is ended by a non-AWU interrupt (e.g. EXTI)
+#if !defined(SW_CLOCK_AWU_MAX)
+  #define SW_CLOCK_AWU_MAX    30000
+#endif
+#if (SW_CLOCK_AWU_MAX < SW_CLOCK_AWU_MIN)
+  #error SW_CLOCK_AWU_MAX must be >= SW_CLOCK_AWU_MIN
+#endif
+
+/// max. number of modules registered via sleep_register(), e.g. SW timer and scheduler
+#if !defined(SW_CLOCK_SLEEP_HOOKS)
+  #define SW_CLOCK_SLEEP_HOOKS  2
+#endif
+
+/// TIM4 overflow occurred (UIF = bit 0), but not yet handled by TIM4 ISR 
+#if defined(TIM4_SR1_RESET_VALUE)
+  #define SW_CLOCK_TIM4_OVF()   (TIM4->SR1 & 0x01)
+#else
+  #define SW_CLOCK_TIM4_OVF()   (TIM4->SR & 0x01)
+#endif
+
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+#if defined(SW_CLOCK_TICKLESS)
+
+  /// get ticks [ms] until next event which requires a TIM4 tick (>=1), or 0xFFFFFFFF if none
+  typedef uint32_t (*sleep_next_t)(void);
+
+  /// catch up ticks [ms] skipped in active-halt. Is called with TIM4 interrupt disabled
+  typedef void (*sleep_advance_t)(uint32_t Ticks);
+
+#endif // SW_CLOCK_TICKLESS
 
 
 /*-----------------------------------------------------------------------------
@@ -54,6 +119,29 @@ uint32_t millis(void);
 /// delay code execution for specified milliseconds
 void delay(uint32_t ms);
 
+/// sleep for specified milliseconds in low power mode
+void sleep_ms(uint32_t ms);
+
+#if defined(SW_CLOCK_TICKLESS)
+
+  /// register module which limits active-halt in sleep_ms() and catches up skipped ticks
+  bool sleep_register(sleep_next_t Next, sleep_advance_t Advance);
+
+#endif // SW_CLOCK_TICKLESS
+
+/// get 48-bit milliseconds since start of program. Overruns after ~8900 years
+void uptime_ms48(uint16_t *High, uint32_t *Low);
+
+#if defined(SW_CLOCK_UPTIME64)
+
+  /// get 64-bit milliseconds since start of program (48-bit counter)
+  uint64_t uptime_ms(void);
+
+  /// get 64-bit microseconds since start of program. Resolution is 4us
+  uint64_t uptime_us(void);
+
+#endif // SW_CLOCK_UPTIME64
+
 
 /**
   \fn uint32_t micros(void)
@@ -64,7 +152,9 @@ void delay(uint32_t ms);
 
   Get microseconds from start of program with 4us resolution. 
   Requires TIM4 to be initialized and running, and TIM4 interrupt being active.
-  Value overruns every ~1.2 hours.
+  Value overruns every ~1.2 hours, for longer durations use uptime_us().
+  Lock-free: TIM4 keeps running and TIM4 interrupt is not disabled. Instead g_micros is read 
+  again after TIM4 counter, and the read is repeated if the TIM4 ISR has changed it meanwhile.
   Inline implementation for minimal latency.
 */
 #if defined(__CSMC__)
@@ -73,42 +163,36 @@ void delay(uint32_t ms);
   static inline uint32_t micros(void)
 #endif
 {
-  // for consistency of CNT ans SR briefly stop timer. Use direct register access for low latency
-  TIM4->CR1 &= TIM4_CR1_CEN;
-
-  // get current us value, TIM4 counter, and TIM4 overflow flag
-  uint8_t cnt = TIM4->CNTR;
-  #if defined(TIM4_SR1_RESET_VALUE)
-    uint8_t uif = TIM4->SR1;
-  #else
-    uint8_t uif = TIM4->SR;
-  #endif
-  
-  // restart timer immediately to minimize time gap. Use direct register access for low latency
-  TIM4->CR1 |= TIM4_CR1_CEN;
+  uint32_t  us;
+  uint16_t  ovf;
+  uint8_t   cnt;
+
+  do
+  {
+    // copy micros from global variable
+    us  = g_micros;
+    ovf = 0;
+
+    // get TIM4 counter (4us steps)
+    cnt = TIM4->CNTR;
+
+    // account for TIM4 overflow not yet handled by ISR (e.g. interrupts disabled). Then re-read counter after overflow
+    if (SW_CLOCK_TIM4_OVF())
+    {
+      cnt = TIM4->CNTR;
+      ovf = 1000;
+    }
+
+  } while (us != g_micros);   // TIM4 ISR changed g_micros (or torn read) -> repeat
   
 
-  // store TIM4 interrupt state and disable it to avoid race condition with TIM4 ISR
-  uint8_t oldTIM4_IER = TIM4->IER;
-  TIM4->IER &= ~TIM4_IT_UPDATE;
-
-  // copy micros from global variable
-  uint32_t us = g_micros;
-
-  // restore original TIM4 TIM4 interrupt state
-  TIM4->IER = oldTIM4_IER;
-
-
-  // calculate current time [us], including global variable (1000us steps) and counter value (4us steps)
+  // calculate current time [us], including global variable (1000us steps), pending overflow and counter value (4us steps)
+  us += ovf;
   #if defined(__CSMC__)     // Cosmic compiler has a re-entrance bug with bitshift
     us += 4 * (uint16_t) cnt;
   #else
     us += ((uint16_t) cnt) << 2;
   #endif
-  
-  // account for possible overflow of TIM4 --> check UIF (= bit 0)
-  if ((uif & 0x01) && (cnt != 250))
-    us += 1000L;
 
   // return current micros
   return(us);
@@ -160,13 +244,43 @@ void delay(uint32_t ms);
   // clear timer 4 interrupt flag
   TIM4_ClearITPendingBit(TIM4_IT_UPDATE);
 
-  // set/increase global variables
+  // set/increase global variables. Extend ms counter to 48 bit
   g_micros += 1000L;
-  g_millis++;
+  if (++g_millis == 0)
+    g_millisHigh++;
   g_flagMilli = TRUE;
 
 } // ISR_TIM4_handler
 
+
+
+#if defined(SW_CLOCK_TICKLESS)
+
+/**
+  \fn void ISR_AWU_handler(void)
+   
+  \brief inline handler for AWU wake-up from active-halt
+  
+  AWU interrupt handler. Is called from within actual AWU ISR in stm8s_it.c.
+  Signals sleep_ms() that the active-halt duration has passed.
+  Inline implementation for minimal latency.
+*/
+#if defined(__CSMC__)
+  @inline void ISR_AWU_handler(void)
+#else // SDCC & IAR
+  static inline void ISR_AWU_handler(void)
+#endif
+{
+  // clear AWU interrupt flag (cleared by reading AWU_CSR)
+  AWU_GetFlagStatus();
+
+  // signal wake-up by AWU
+  g_flagAWU = TRUE;
+
+} // ISR_AWU_handler
+
+#endif // SW_CLOCK_TICKLESS
+
 /*-----------------------------------------------------------------------------
     END OF MODULE DEFINITION FOR MULTIPLE INLUSION
 -----------------------------------------------------------------------------*/
@@ -0,0 +1,513 @@
+/**********************
+  implementation of hierarchical SW timer wheel based on SW clock
+
+  One-shot and periodic timers with statically allocated nodes (no heap).
+  Timers are sorted into SW_TIMER_LEVELS levels of SW_TIMER_SLOTS slots each, i.e.
+  start and stop are O(1) and the 1ms tick only handles the current slot instead of
+  scanning all timers. Timers of higher levels are moved (cascaded) to lower levels
+  once per SW_TIMER_SLOTS ticks of the lower level.
+  Callbacks are either called directly from the TIM4 ISR or deferred to the
+  main loop via sw_timer_process()
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "sw_timer.h"
+
+
+/*----------------------------------------------------------
+    MODULE MACROS
+----------------------------------------------------------*/
+
+// state of deferred callback (sw_timer_t.pending)
+#define PEND_NONE       0     // not in list of pending callbacks
+#define PEND_QUEUED     1     // in list, callback is called by sw_timer_process()
+#define PEND_CANCELLED  2     // in list, but timer was stopped -> skip callback
+
+// range of timer wheel [ms]. Timers beyond are parked in last slot of top level
+#define WHEEL_RANGE     (1UL << (SW_TIMER_SLOT_BITS * SW_TIMER_LEVELS))
+
+// disable/restore TIM4 interrupt to avoid race condition with sw_timer_tick()
+#define TIMER_LOCK(old)     { old = TIM4->IER; TIM4->IER &= ~TIM4_IT_UPDATE; }
+#define TIMER_UNLOCK(old)   { TIM4->IER = old; }
+
+
+/*----------------------------------------------------------
+    MODULE VARIABLES
+----------------------------------------------------------*/
+
+// slots of timer wheel. Each slot is a doubly linked list of timers
+static sw_timer_t     *s_wheel[SW_TIMER_LEVELS][SW_TIMER_SLOTS];
+
+// timers expiring in current tick (detached from wheel). Timers may be stopped by callbacks
+static sw_timer_t     *s_expired;
+
+// FIFO of timers with pending deferred callback
+static sw_timer_t     *s_pendHead, *s_pendTail;
+
+// current tick of timer wheel [ms]. Only changed in sw_timer_tick() and sw_timer_advance()
+static volatile uint32_t s_now;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void list_add(sw_timer_t **Head, sw_timer_t *Timer)
+
+  \brief add timer to start of list
+
+  \param[in,out] Head   list head, e.g. wheel slot
+  \param[in,out] Timer  timer to add
+*/
+static void list_add(sw_timer_t **Head, sw_timer_t *Timer)
+{
+  Timer->next = *Head;
+  if (Timer->next != NULL)
+    Timer->next->pprev = &(Timer->next);
+  Timer->pprev = Head;
+  *Head = Timer;
+
+} // list_add()
+
+
+
+/**
+  \fn void list_del(sw_timer_t *Timer)
+
+  \brief remove timer from its list in O(1)
+
+  \param[in,out] Timer  timer to remove. Must be in a list
+*/
+static void list_del(sw_timer_t *Timer)
+{
+  *(Timer->pprev) = Timer->next;
+  if (Timer->next != NULL)
+    Timer->next->pprev = Timer->pprev;
+  Timer->next  = NULL;
+  Timer->pprev = NULL;
+
+} // list_del()
+
+
+
+/**
+  \fn void wheel_add(sw_timer_t *Timer)
+
+  \brief sort timer into wheel slot
+
+  \param[in,out] Timer  timer to add. Timer->expires must be after s_now
+
+  Select lowest level which covers the remaining time. Slot index is taken from
+  the absolute expiry tick, i.e. the slot is handled (level 0) or cascaded
+  (higher levels) before expiry. Timers beyond the wheel range are parked in the
+  last slot of the top level and re-sorted when this is cascaded
+*/
+static void wheel_add(sw_timer_t *Timer)
+{
+  uint32_t  delta = Timer->expires - s_now;
+  uint32_t  tick  = Timer->expires;
+  uint8_t   level, shift = 0;
+
+  // find lowest level covering remaining time
+  for (level = 0; level < SW_TIMER_LEVELS-1; level++)
+  {
+    if (delta < (1UL << (shift + SW_TIMER_SLOT_BITS)))
+      break;
+    shift += SW_TIMER_SLOT_BITS;
+  }
+
+  // beyond wheel range -> park in last slot of top level
+  if (delta >= WHEEL_RANGE)
+    tick = s_now + WHEEL_RANGE - 1;
+
+  list_add(&(s_wheel[level][(uint8_t) (tick >> shift) & SW_TIMER_SLOT_MASK]), Timer);
+
+} // wheel_add()
+
+
+
+/**
+  \fn void wheel_cascade(uint8_t Level, uint8_t Slot)
+
+  \brief move timers of one slot to lower levels
+
+  \param[in] Level  wheel level (>=1)
+  \param[in] Slot   slot index
+
+  Detach complete slot and re-sort all its timers relative to current tick
+*/
+static void wheel_cascade(uint8_t Level, uint8_t Slot)
+{
+  sw_timer_t  *list = s_wheel[Level][Slot];
+  sw_timer_t  *timer;
+
+  s_wheel[Level][Slot] = NULL;
+  while (list != NULL)
+  {
+    timer = list;
+    list  = timer->next;
+    wheel_add(timer);
+  }
+
+} // wheel_cascade()
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void sw_timer_init(void)
+
+  \brief initialize timer wheel
+
+  Clear all wheel slots and pending callbacks. Requires SW clock to be running
+  and sw_timer_tick() being called from TIM4 ISR. If SW_CLOCK_TICKLESS is defined,
+  the wheel is registered for sleep_ms() via sleep_register()
+*/
+void sw_timer_init(void)
+{
+  uint8_t   level, slot, oldTIM4_IER;
+
+  TIMER_LOCK(oldTIM4_IER);
+
+  for (level = 0; level < SW_TIMER_LEVELS; level++)
+    for (slot = 0; slot < SW_TIMER_SLOTS; slot++)
+      s_wheel[level][slot] = NULL;
+  s_expired  = NULL;
+  s_pendHead = NULL;
+  s_pendTail = NULL;
+  s_now      = 0;
+
+  TIMER_UNLOCK(oldTIM4_IER);
+
+  // limit active-halt in sleep_ms() to next expiry and catch up skipped ticks
+  #if defined(SW_CLOCK_TICKLESS)
+    sleep_register(sw_timer_next_expiry, sw_timer_advance);
+  #endif
+
+} // sw_timer_init()
+
+
+
+/**
+  \fn void sw_timer_setup(sw_timer_t *Timer, sw_timer_cb_t Callback, void *Ctx, uint8_t Mode)
+
+  \brief configure timer
+
+  \param[out] Timer     timer node (static)
+  \param[in]  Callback  function called on expiry
+  \param[in]  Ctx       user context passed to callback
+  \param[in]  Mode      SW_TIMER_ISR (call from TIM4 ISR) or SW_TIMER_DEFERRED (call from sw_timer_process())
+
+  Initialize timer node. Must not be called for a running timer
+*/
+void sw_timer_setup(sw_timer_t *Timer, sw_timer_cb_t Callback, void *Ctx, uint8_t Mode)
+{
+  Timer->callback    = Callback;
+  Timer->ctx         = Ctx;
+  Timer->mode        = Mode;
+  Timer->next        = NULL;
+  Timer->pprev       = NULL;
+  Timer->nextPending = NULL;
+  Timer->pending     = PEND_NONE;
+  Timer->expires     = 0;
+  Timer->period      = 0;
+
+} // sw_timer_setup()
+
+
+
+/**
+  \fn void sw_timer_start(sw_timer_t *Timer, uint32_t Delay, uint32_t Period)
+
+  \brief (re-)start timer
+
+  \param[in,out] Timer    timer node configured via sw_timer_setup()
+  \param[in]     Delay    time until first expiry [ms]. 0 is treated as 1, i.e. next tick
+  \param[in]     Period   period of following expiries [ms]. 0 for one-shot timer
+
+  Start timer in O(1). A running timer is restarted, a pending deferred callback is kept.
+  May also be called from a timer callback
+*/
+void sw_timer_start(sw_timer_t *Timer, uint32_t Delay, uint32_t Period)
+{
+  uint8_t   oldTIM4_IER;
+
+  if (Delay == 0)
+    Delay = 1;
+
+  TIMER_LOCK(oldTIM4_IER);
+
+  // remove from wheel if running
+  if (Timer->pprev != NULL)
+    list_del(Timer);
+
+  // sort into wheel
+  Timer->period  = Period;
+  Timer->expires = s_now + Delay;
+  wheel_add(Timer);
+
+  TIMER_UNLOCK(oldTIM4_IER);
+
+} // sw_timer_start()
+
+
+
+/**
+  \fn void sw_timer_stop(sw_timer_t *Timer)
+
+  \brief stop timer
+
+  \param[in,out] Timer    timer node
+
+  Stop timer in O(1) and discard a pending deferred callback.
+  May also be called from a timer callback
+*/
+void sw_timer_stop(sw_timer_t *Timer)
+{
+  uint8_t   oldTIM4_IER;
+
+  TIMER_LOCK(oldTIM4_IER);
+
+  // remove from wheel or list of expired timers
+  if (Timer->pprev != NULL)
+    list_del(Timer);
+
+  // timer stays in FIFO, but callback is skipped
+  if (Timer->pending == PEND_QUEUED)
+    Timer->pending = PEND_CANCELLED;
+
+  TIMER_UNLOCK(oldTIM4_IER);
+
+} // sw_timer_stop()
+
+
+
+/**
+  \fn bool sw_timer_running(sw_timer_t *Timer)
+
+  \brief check if timer is running
+
+  \param[in] Timer    timer node
+
+  \return TRUE if timer is running, else FALSE (one-shot expired or stopped)
+*/
+bool sw_timer_running(sw_timer_t *Timer)
+{
+  return (Timer->pprev != NULL);
+
+} // sw_timer_running()
+
+
+
+/**
+  \fn uint32_t sw_timer_next_expiry(void)
+
+  \brief get ticks until next timer expiry
+
+  \return ticks [ms] until earliest expiry of running timers (>=1), or 0xFFFFFFFF if no timer is running
+
+  Scan all wheel slots, because timers of higher levels may expire before timers
+  of lower levels until they are cascaded. Is used by sleep_ms() to limit active-halt
+*/
+uint32_t sw_timer_next_expiry(void)
+{
+  sw_timer_t  *timer;
+  uint32_t    delta, next = 0xFFFFFFFF;
+  uint8_t     level, slot, oldTIM4_IER;
+
+  TIMER_LOCK(oldTIM4_IER);
+
+  for (level = 0; level < SW_TIMER_LEVELS; level++)
+  {
+    for (slot = 0; slot < SW_TIMER_SLOTS; slot++)
+    {
+      for (timer = s_wheel[level][slot]; timer != NULL; timer = timer->next)
+      {
+        delta = timer->expires - s_now;
+        if (delta < next)
+          next = delta;
+      }
+    }
+  }
+
+  TIMER_UNLOCK(oldTIM4_IER);
+
+  return next;
+
+} // sw_timer_next_expiry()
+
+
+
+/**
+  \fn void sw_timer_advance(uint32_t Ticks)
+
+  \brief catch up ticks skipped in active-halt
+
+  \param[in] Ticks    number of skipped ticks [ms]
+
+  Advance wheel by 'Ticks' at once and re-sort all running timers relative to the
+  new tick, i.e. like a restart with the remaining time. No callbacks are called, 
+  because sleep_ms() limits 'Ticks' to less than sw_timer_next_expiry(). 
+  Timers which would have expired meanwhile expire on the next tick instead.
+  Is called by sleep_ms() after wake-up from active-halt
+*/
+void sw_timer_advance(uint32_t Ticks)
+{
+  sw_timer_t  *list = NULL;
+  sw_timer_t  *timer;
+  uint8_t     level, slot, oldTIM4_IER;
+
+  TIMER_LOCK(oldTIM4_IER);
+
+  // detach all timers from wheel
+  for (level = 0; level < SW_TIMER_LEVELS; level++)
+  {
+    for (slot = 0; slot < SW_TIMER_SLOTS; slot++)
+    {
+      while ((timer = s_wheel[level][slot]) != NULL)
+      {
+        list_del(timer);
+        list_add(&list, timer);
+      }
+    }
+  }
+
+  // advance wheel
+  s_now += Ticks;
+
+  // re-sort timers relative to new tick. Overdue timers expire on next tick
+  while ((timer = list) != NULL)
+  {
+    list_del(timer);
+    if ((int32_t) (timer->expires - s_now) <= 0)
+      timer->expires = s_now + 1;
+    wheel_add(timer);
+  }
+
+  TIMER_UNLOCK(oldTIM4_IER);
+
+} // sw_timer_advance()
+
+
+
+/**
+  \fn void sw_timer_process(void)
+
+  \brief call pending deferred callbacks
+
+  Call callbacks of expired SW_TIMER_DEFERRED timers in order of expiry.
+  Multiple expiries of the same timer before this call result in a single call.
+  Call from main loop as often as possible
+*/
+void sw_timer_process(void)
+{
+  sw_timer_t  *timer;
+  uint8_t     state, oldTIM4_IER;
+
+  while (1)
+  {
+    // get next timer from FIFO
+    TIMER_LOCK(oldTIM4_IER);
+    timer = s_pendHead;
+    if (timer != NULL)
+    {
+      s_pendHead = timer->nextPending;
+      if (s_pendHead == NULL)
+        s_pendTail = NULL;
+      state = timer->pending;
+      timer->pending = PEND_NONE;
+    }
+    TIMER_UNLOCK(oldTIM4_IER);
+
+    // no more pending callbacks
+    if (timer == NULL)
+      break;
+
+    // call callback if timer was not stopped meanwhile
+    if (state == PEND_QUEUED)
+      (timer->callback)(timer->ctx);
+
+  } // while (1)
+
+} // sw_timer_process()
+
+
+
+/**
+  \fn void sw_timer_tick(void)
+
+  \brief 1ms tick of timer wheel
+
+  Advance wheel by 1 tick, cascade higher levels if lower slot index wrapped around
+  and handle all timers of current level 0 slot. Periodic timers are re-started
+  relative to their previous expiry, i.e. without drift.
+  Is called from within actual TIM4 ISR in stm8s_it.c after ISR_TIM4_handler()
+*/
+void sw_timer_tick(void)
+{
+  sw_timer_t  *timer;
+  uint8_t     level, shift;
+
+  s_now++;
+
+  // cascade from top to bottom, so that timers can move down multiple levels at once
+  shift = SW_TIMER_SLOT_BITS * (SW_TIMER_LEVELS-1);
+  for (level = SW_TIMER_LEVELS-1; level > 0; level--)
+  {
+    if ((s_now & ((1UL << shift) - 1)) == 0)
+      wheel_cascade(level, (uint8_t) (s_now >> shift) & SW_TIMER_SLOT_MASK);
+    shift -= SW_TIMER_SLOT_BITS;
+  }
+
+  // detach current slot. All timers in it expire now
+  s_expired = NULL;
+  timer = s_wheel[0][(uint8_t) s_now & SW_TIMER_SLOT_MASK];
+  if (timer != NULL)
+  {
+    s_wheel[0][(uint8_t) s_now & SW_TIMER_SLOT_MASK] = NULL;
+    s_expired = timer;
+    timer->pprev = &s_expired;
+  }
+
+  // handle expired timers. Callbacks may stop or start any timer
+  while ((timer = s_expired) != NULL)
+  {
+    list_del(timer);
+
+    // re-start periodic timer
+    if (timer->period != 0)
+    {
+      timer->expires += timer->period;
+      wheel_add(timer);
+    }
+
+    // call callback directly
+    if (timer->mode == SW_TIMER_ISR)
+      (timer->callback)(timer->ctx);
+
+    // defer callback to sw_timer_process()
+    else if (timer->pending == PEND_NONE)
+    {
+      timer->nextPending = NULL;
+      if (s_pendTail != NULL)
+        s_pendTail->nextPending = timer;
+      else
+        s_pendHead = timer;
+      s_pendTail = timer;
+      timer->pending = PEND_QUEUED;
+    }
+    else
+      timer->pending = PEND_QUEUED;
+
+  } // loop over expired timers
+
+} // sw_timer_tick()
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,120 @@
+/**********************
+  declaration of hierarchical SW timer wheel based on SW clock
+
+  One-shot and periodic timers with statically allocated nodes (no heap).
+  Timers are sorted into SW_TIMER_LEVELS levels of SW_TIMER_SLOTS slots each, i.e.
+  start and stop are O(1) and the 1ms tick only handles the current slot instead of
+  scanning all timers. Timers of higher levels are moved (cascaded) to lower levels
+  once per SW_TIMER_SLOTS ticks of the lower level.
+  Callbacks are either called directly from the TIM4 ISR or deferred to the
+  main loop via sw_timer_process().
+  With SW_CLOCK_TICKLESS, sleep_ms() halts until the tick before the next expiry 
+  and catches up the skipped ticks via sw_timer_advance()
+**********************/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SW_TIMER_H_
+#define _SW_TIMER_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+
+#include "stm8s.h"
+#include "sw_clock.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// number of wheel levels. Range w/o cascade parking is SW_TIMER_SLOTS^SW_TIMER_LEVELS ms
+#if !defined(SW_TIMER_LEVELS)
+  #define SW_TIMER_LEVELS     3
+#endif
+#if (SW_TIMER_LEVELS < 1) || (SW_TIMER_LEVELS > 7)
+  #error SW_TIMER_LEVELS must be in range 1..7
+#endif
+
+/// number of slots per level as power of 2 [bits]. Default 16 slots, i.e. 4096ms range for 3 levels
+#if !defined(SW_TIMER_SLOT_BITS)
+  #define SW_TIMER_SLOT_BITS  4
+#endif
+#if (SW_TIMER_SLOT_BITS < 1) || (SW_TIMER_SLOT_BITS * SW_TIMER_LEVELS > 28)
+  #error SW_TIMER_SLOT_BITS must be >=1 and SW_TIMER_SLOT_BITS*SW_TIMER_LEVELS <= 28
+#endif
+
+#define SW_TIMER_SLOTS        (1 << SW_TIMER_SLOT_BITS)     ///< number of slots per level
+#define SW_TIMER_SLOT_MASK    (SW_TIMER_SLOTS - 1)          ///< mask for slot index
+
+/// timer callback mode
+#define SW_TIMER_ISR          0     ///< call callback directly from TIM4 ISR. Keep short!
+#define SW_TIMER_DEFERRED     1     ///< call callback from main loop via sw_timer_process()
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// timer callback. Ctx is the user context passed to sw_timer_setup()
+typedef void (*sw_timer_cb_t)(void *Ctx);
+
+
+/// timer node. Allocate statically and configure via sw_timer_setup(). Members are managed by sw_timer.c
+typedef struct sw_timer_s
+{
+  // configuration
+  sw_timer_cb_t                 callback;     ///< function called on expiry
+  void                          *ctx;         ///< user context passed to callback
+  uint8_t                       mode;         ///< SW_TIMER_ISR or SW_TIMER_DEFERRED
+
+  // state
+  struct sw_timer_s             *next;        ///< next timer in same wheel slot
+  struct sw_timer_s             **pprev;      ///< address of pointer to this timer in wheel slot. NULL if not running
+  struct sw_timer_s             *nextPending; ///< next timer in list of deferred callbacks
+  volatile uint8_t              pending;      ///< state of deferred callback, see sw_timer.c
+  uint32_t                      expires;      ///< tick of next expiry [ms]
+  uint32_t                      period;       ///< period [ms]. 0 for one-shot timer
+
+} sw_timer_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// @brief initialize timer wheel. Call once before other sw_timer functions
+void sw_timer_init(void);
+
+/// @brief configure timer callback and mode. Timer must not be running
+void sw_timer_setup(sw_timer_t *Timer, sw_timer_cb_t Callback, void *Ctx, uint8_t Mode);
+
+/// @brief (re-)start timer with delay [ms] to first expiry and period [ms] (0 = one-shot)
+void sw_timer_start(sw_timer_t *Timer, uint32_t Delay, uint32_t Period);
+
+/// @brief stop timer and discard a pending deferred callback
+void sw_timer_stop(sw_timer_t *Timer);
+
+/// @brief check if timer is running
+bool sw_timer_running(sw_timer_t *Timer);
+
+/// @brief get ticks [ms] until next timer expiry, or 0xFFFFFFFF if no timer is running
+uint32_t sw_timer_next_expiry(void);
+
+/// @brief catch up ticks [ms] skipped in active-halt of sleep_ms(). Must be less than sw_timer_next_expiry()
+void sw_timer_advance(uint32_t Ticks);
+
+/// @brief call pending deferred callbacks. Call from main loop
+void sw_timer_process(void);
+
+/// @brief 1ms tick of timer wheel. Call from TIM4 ISR after ISR_TIM4_handler()
+void sw_timer_tick(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _SW_TIMER_H_
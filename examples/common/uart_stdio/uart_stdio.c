@@ -19,8 +19,11 @@
   \param[in]  c   byte to output to UART
    
   Output function for printf() via UART. 
-  Pointers to UART functions need to be configured first, see "uart_stdio.h"  
-  Type is compiler and version dependent
+  For UART_STDIO_PORT=0 pointers to UART functions need to be configured first, see "uart_stdio.h"  
+  Type is compiler and version dependent.
+  For UART_TX_BUFFER_SIZE>0 only store byte in TX buffer, which is sent by the TX ISR.
+  Then g_UART_ITConfig is also required (for UART_STDIO_PORT=0). Note that the UART_TX_OVERFLOW_BLOCK policy requires
+  enabled interrupts, i.e. don't print to a full buffer from an ISR or during initialization
 */
 #if defined (_COSMIC_)
   char putchar(char c)
@@ -28,11 +31,42 @@
   int putchar(int c)
 #endif 
 {
+#if (UART_TX_BUFFER_SIZE > 0)
+
+  uint8_t   level;
+
+  // buffer full -> wait for ISR or drop byte
+  #if (UART_TX_OVERFLOW == UART_TX_OVERFLOW_DROP)
+    if ((uint8_t) (g_UART_TxHead - g_UART_TxTail) >= UART_TX_BUFFER_SIZE)
+    {
+      g_UART_TxDropped++;
+      return (c);
+    }
+  #else
+    while ((uint8_t) (g_UART_TxHead - g_UART_TxTail) >= UART_TX_BUFFER_SIZE);
+  #endif
+
+  // store byte in buffer. Index is only changed here, i.e. no need to lock
+  g_UART_TxBuf[g_UART_TxHead & (UART_TX_BUFFER_SIZE-1)] = (uint8_t) c;
+  g_UART_TxHead++;
+
+  // update buffer statistics
+  level = (uint8_t) (g_UART_TxHead - g_UART_TxTail);
+  if (level > g_UART_TxHighWater)
+    g_UART_TxHighWater = level;
+
+  // enable TXE interrupt to start transmission
+  UART_STDIO_TXE_IT(ENABLE);
+
+#else // UART_TX_BUFFER_SIZE
+
   // send byte via UART
-  (*g_UART_SendData8)(c);
+  UART_STDIO_SEND(c);
 
   // wait for end of transmission
-  while ((*g_UART_GetFlagStatus)(UART1_FLAG_TXE) == RESET);
+  while (UART_STDIO_FLAG(UART1_FLAG_TXE) == RESET);
+
+#endif // UART_TX_BUFFER_SIZE
 
   // return sent byte
   return (c);
@@ -41,15 +75,41 @@
 
 
 
+/**
+  \fn void uart_flush(void)
+   
+  \brief wait until TX buffer is empty
+   
+  Wait until all bytes in TX buffer are sent and the last transmission is completed,
+  e.g. before a reset or entering low-power mode. Requires enabled interrupts.
+*/
+void uart_flush(void)
+{
+#if (UART_TX_BUFFER_SIZE > 0)
+
+  // wait until TX ISR has sent all data
+  while (g_UART_TxHead != g_UART_TxTail);
+
+#endif // UART_TX_BUFFER_SIZE
+
+  // wait for end of last transmission
+  while (UART_STDIO_FLAG(UART1_FLAG_TC) == RESET);
+
+} // uart_flush()
+
+
+
 /**
   \fn char getchar(void)
    
   \brief input function for getchar() via UART
   \return byte read from UART
    
-  Input function for getchar() via UART. 
-  Pointers to UART functions need to be configured first, see "uart_stdio.h"  
-  Type is compiler and version dependent
+  Input function for getchar() via UART. Wait until a byte is received. 
+  For UART_STDIO_PORT=0 pointers to UART functions need to be configured first, see "uart_stdio.h"  
+  Type is compiler and version dependent.
+  For UART_RX_BUFFER_SIZE>0 read from RX buffer, which is filled by the RX ISR.
+  Then RXNE interrupt needs to be enabled, e.g. UART3_ITConfig(UART3_IT_RXNE_OR, ENABLE)
 */
 #if defined (_COSMIC_)
   char getchar(void)
@@ -57,14 +117,83 @@
   int getchar(void)
 #endif 
 {
+  int16_t   c;
+
   // wait for byte received via UART
-  while ((*g_UART_GetFlagStatus)(UART1_FLAG_RXNE) == RESET);
+  while ((c = uart_read()) < 0);
 
-  // read and return byte
-  return ((*g_UART_ReceiveData8)());
+  // return byte
+  return (c);
 
 } // getchar()
 
+
+
+/**
+  \fn uint8_t uart_available(void)
+   
+  \brief get number of received bytes
+  \return number of bytes available for uart_read()
+   
+  Get number of received bytes in RX buffer. 
+  For UART_RX_BUFFER_SIZE=0 return 1 if a byte was received, else 0.
+*/
+uint8_t uart_available(void)
+{
+#if (UART_RX_BUFFER_SIZE > 0)
+
+  // number of bytes in RX buffer
+  return ((uint8_t) (g_UART_RxHead - g_UART_RxTail));
+
+#else // UART_RX_BUFFER_SIZE
+
+  // check UART receive flag
+  return ((UART_STDIO_FLAG(UART1_FLAG_RXNE) == SET) ? 1 : 0);
+
+#endif // UART_RX_BUFFER_SIZE
+
+} // uart_available()
+
+
+
+/**
+  \fn int16_t uart_read(void)
+   
+  \brief read received byte (non-blocking)
+  \return received byte (0..255), or -1 if no data available
+   
+  Read next received byte without waiting. 
+  For UART_RX_BUFFER_SIZE>0 read from RX buffer, else directly from UART.
+*/
+int16_t uart_read(void)
+{
+  uint8_t   c;
+
+#if (UART_RX_BUFFER_SIZE > 0)
+
+  // no data in buffer
+  if (g_UART_RxHead == g_UART_RxTail)
+    return (-1);
+
+  // read byte from buffer. Index is only changed here, i.e. no need to lock
+  c = g_UART_RxBuf[g_UART_RxTail & (UART_RX_BUFFER_SIZE-1)];
+  g_UART_RxTail++;
+
+#else // UART_RX_BUFFER_SIZE
+
+  // no byte received
+  if (UART_STDIO_FLAG(UART1_FLAG_RXNE) == RESET)
+    return (-1);
+
+  // read byte from UART
+  c = UART_STDIO_RECEIVE();
+
+#endif // UART_RX_BUFFER_SIZE
+
+  return ((int16_t) c);
+
+} // uart_read()
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
@@ -1,5 +1,9 @@
 /**********************
   declaration of functions for stdio input/output
+
+  UART access is either via runtime function pointers to SPL routines (UART_STDIO_PORT=0, default),
+  or via direct register access to UART1/2/3 (UART_STDIO_PORT=1/2/3), which avoids the indirect
+  function calls per byte
 **********************/
 
 /*-----------------------------------------------------------------------------
@@ -18,6 +22,63 @@
 #include <stdio.h>
 
 
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// TX buffer size [B] for interrupt driven putchar(). Power of 2 (2..128), or 0 for blocking output (default)
+#if !defined(UART_TX_BUFFER_SIZE)
+  #define UART_TX_BUFFER_SIZE       0
+#endif
+#if (UART_TX_BUFFER_SIZE == 1) || (UART_TX_BUFFER_SIZE > 128) || ((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE-1)) != 0)
+  #error UART_TX_BUFFER_SIZE must be 0 or a power of 2 in range 2..128
+#endif
+
+/// RX buffer size [B] for interrupt driven getchar() and uart_read(). Power of 2 (2..128), or 0 for polling (default)
+#if !defined(UART_RX_BUFFER_SIZE)
+  #define UART_RX_BUFFER_SIZE       0
+#endif
+#if (UART_RX_BUFFER_SIZE == 1) || (UART_RX_BUFFER_SIZE > 128) || ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE-1)) != 0)
+  #error UART_RX_BUFFER_SIZE must be 0 or a power of 2 in range 2..128
+#endif
+
+/// policy if TX buffer is full: wait for ISR to send data (block), or discard new data (drop)
+#define UART_TX_OVERFLOW_BLOCK      0
+#define UART_TX_OVERFLOW_DROP       1
+#if !defined(UART_TX_OVERFLOW)
+  #define UART_TX_OVERFLOW          UART_TX_OVERFLOW_BLOCK
+#endif
+
+/// UART used for stdio: 1/2/3 = direct register access to UART1/2/3, 0 = via function pointers g_UART_xxx (default)
+#if !defined(UART_STDIO_PORT)
+  #define UART_STDIO_PORT           0
+#endif
+
+// select UART for direct register access. Register layout of SR, DR and CR2 is identical for all UARTs
+#if (UART_STDIO_PORT == 1)
+  #define UART_STDIO                UART1
+#elif (UART_STDIO_PORT == 2)
+  #define UART_STDIO                UART2
+#elif (UART_STDIO_PORT == 3)
+  #define UART_STDIO                UART3
+#elif (UART_STDIO_PORT != 0)
+  #error UART_STDIO_PORT must be 0..3
+#endif
+
+// UART access macros. Flags are UART1_FLAG_xxx (same bits in SR for all UARTs)
+#if (UART_STDIO_PORT > 0)
+  #define UART_STDIO_SEND(c)        (UART_STDIO->DR = (uint8_t) (c))                                  ///< send byte
+  #define UART_STDIO_RECEIVE()      (UART_STDIO->DR)                                                  ///< read received byte
+  #define UART_STDIO_FLAG(flag)     ((UART_STDIO->SR & (uint8_t) (flag)) ? SET : RESET)              ///< get status flag
+  #define UART_STDIO_TXE_IT(state)  ((state) ? (UART_STDIO->CR2 |= UART1_CR2_TIEN) : (UART_STDIO->CR2 &= (uint8_t) ~UART1_CR2_TIEN))   ///< enable/disable TXE interrupt
+#else
+  #define UART_STDIO_SEND(c)        (*g_UART_SendData8)(c)
+  #define UART_STDIO_RECEIVE()      (*g_UART_ReceiveData8)()
+  #define UART_STDIO_FLAG(flag)     (*g_UART_GetFlagStatus)(flag)
+  #define UART_STDIO_TXE_IT(state)  (*g_UART_ITConfig)(UART1_IT_TXE, (state))
+#endif
+
+
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL VARIABLES
 -----------------------------------------------------------------------------*/
@@ -27,13 +88,137 @@
   volatile void       (*g_UART_SendData8) (uint8_t) = NULL;                            //!< UART send byte function
   volatile uint8_t    (*g_UART_ReceiveData8)(void) = NULL;                             //!< UART read byte function
   volatile FlagStatus (*g_UART_GetFlagStatus) (UART1_Flag_TypeDef UART_FLAG) = NULL;   //!< UART check status function
+  volatile void       (*g_UART_ITConfig) (UART1_IT_TypeDef UART_IT, FunctionalState NewState) = NULL;  //!< UART interrupt enable function (only for TX buffer)
+  #if (UART_TX_BUFFER_SIZE > 0)
+    volatile uint8_t  g_UART_TxBuf[UART_TX_BUFFER_SIZE];                               //!< TX ring buffer
+    volatile uint8_t  g_UART_TxHead = 0;                                               //!< TX buffer write index (free running). Changed by putchar()
+    volatile uint8_t  g_UART_TxTail = 0;                                               //!< TX buffer read index (free running). Changed in TX ISR
+    volatile uint8_t  g_UART_TxHighWater = 0;                                          //!< max. number of bytes in TX buffer
+    volatile uint16_t g_UART_TxDropped = 0;                                            //!< number of bytes dropped due to full TX buffer
+  #endif
+  #if (UART_RX_BUFFER_SIZE > 0)
+    volatile uint8_t  g_UART_RxBuf[UART_RX_BUFFER_SIZE];                               //!< RX ring buffer
+    volatile uint8_t  g_UART_RxHead = 0;                                               //!< RX buffer write index (free running). Changed in RX ISR
+    volatile uint8_t  g_UART_RxTail = 0;                                               //!< RX buffer read index (free running). Changed by getchar() and uart_read()
+    volatile uint16_t g_UART_RxOverrun = 0;                                            //!< number of UART overrun errors (byte lost in HW)
+    volatile uint16_t g_UART_RxFraming = 0;                                            //!< number of UART framing errors (e.g. wrong baudrate)
+    volatile uint16_t g_UART_RxDropped = 0;                                            //!< number of bytes dropped due to full RX buffer
+  #endif
 #else // _MAIN_
   extern volatile void       (*g_UART_SendData8) (uint8_t);
   extern volatile uint8_t    (*g_UART_ReceiveData8)(void);
   extern volatile FlagStatus (*g_UART_GetFlagStatus) (UART1_Flag_TypeDef UART_FLAG);
+  extern volatile void       (*g_UART_ITConfig) (UART1_IT_TypeDef UART_IT, FunctionalState NewState);
+  #if (UART_TX_BUFFER_SIZE > 0)
+    extern volatile uint8_t  g_UART_TxBuf[UART_TX_BUFFER_SIZE];
+    extern volatile uint8_t  g_UART_TxHead;
+    extern volatile uint8_t  g_UART_TxTail;
+    extern volatile uint8_t  g_UART_TxHighWater;
+    extern volatile uint16_t g_UART_TxDropped;
+  #endif
+  #if (UART_RX_BUFFER_SIZE > 0)
+    extern volatile uint8_t  g_UART_RxBuf[UART_RX_BUFFER_SIZE];
+    extern volatile uint8_t  g_UART_RxHead;
+    extern volatile uint8_t  g_UART_RxTail;
+    extern volatile uint16_t g_UART_RxOverrun;
+    extern volatile uint16_t g_UART_RxFraming;
+    extern volatile uint16_t g_UART_RxDropped;
+  #endif
 #endif // _MAIN_
 
 
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// wait until all data in TX buffer is sent, e.g. before a reset
+void uart_flush(void);
+
+/// get number of received bytes available for uart_read()
+uint8_t uart_available(void);
+
+/// read received byte (non-blocking). Return -1 if no data available
+int16_t uart_read(void);
+
+
+/**
+  \fn void ISR_UART_TX_handler(void)
+   
+  \brief inline TX buffer empty handler for UART
+  
+  UART TXE handler. Is called from within actual UART TX ISR in stm8s_it.c.
+  Send next byte from TX buffer, or disable TXE interrupt if buffer is empty.
+  For blocking output (UART_TX_BUFFER_SIZE=0) TXE interrupt is not used.
+  Inline implementation for minimal latency.
+*/
+#if defined(__CSMC__)
+  @inline void ISR_UART_TX_handler(void)
+#else // SDCC & IAR
+  static inline void ISR_UART_TX_handler(void)
+#endif
+{
+#if (UART_TX_BUFFER_SIZE > 0)
+
+  // send next byte. Writing data register clears TXE flag
+  if (g_UART_TxHead != g_UART_TxTail)
+  {
+    UART_STDIO_SEND(g_UART_TxBuf[g_UART_TxTail & (UART_TX_BUFFER_SIZE-1)]);
+    g_UART_TxTail++;
+  }
+
+  // buffer empty -> disable TXE interrupt. Is re-enabled by putchar()
+  else
+    UART_STDIO_TXE_IT(DISABLE);
+
+#endif // UART_TX_BUFFER_SIZE
+
+} // ISR_UART_TX_handler
+
+
+
+/**
+  \fn void ISR_UART_RX_handler(void)
+   
+  \brief inline RX buffer full handler for UART
+  
+  UART RXNE/overrun handler. Is called from within actual UART RX ISR in stm8s_it.c.
+  Count receive errors and store received byte in RX buffer.
+  For polling input (UART_RX_BUFFER_SIZE=0) RXNE interrupt is not used.
+  Inline implementation for minimal latency.
+*/
+#if defined(__CSMC__)
+  @inline void ISR_UART_RX_handler(void)
+#else // SDCC & IAR
+  static inline void ISR_UART_RX_handler(void)
+#endif
+{
+#if (UART_RX_BUFFER_SIZE > 0)
+
+  uint8_t   data;
+
+  // count receive errors. Error flags are cleared by reading status register, then data register
+  if (UART_STDIO_FLAG(UART1_FLAG_OR) == SET)
+    g_UART_RxOverrun++;
+  if (UART_STDIO_FLAG(UART1_FLAG_FE) == SET)
+    g_UART_RxFraming++;
+
+  // read received byte. Also clears RXNE flag
+  data = UART_STDIO_RECEIVE();
+
+  // store byte in buffer, or drop if buffer is full
+  if ((uint8_t) (g_UART_RxHead - g_UART_RxTail) < UART_RX_BUFFER_SIZE)
+  {
+    g_UART_RxBuf[g_UART_RxHead & (UART_RX_BUFFER_SIZE-1)] = data;
+    g_UART_RxHead++;
+  }
+  else
+    g_UART_RxDropped++;
+
+#endif // UART_RX_BUFFER_SIZE
+
+} // ISR_UART_RX_handler
+
+
 /*-----------------------------------------------------------------------------
     END OF MODULE DEFINITION FOR MULTIPLE INLUSION
 -----------------------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+# -*- coding: utf-8 -*-
+"""
+PlatformIO post-build script: fill unused flash and add reference checksum to firmware
+
+After linking, the firmware *.ihx is patched via "../common/checksum/test_checksums/add_checksum.py":
+  - unused flash in CHK_ADDR_START..CHK_ADDR_END is filled with 0x75 (illegal opcode)
+  - Fletcher-16 checksum over CHK_ADDR_START..CHK_ADDR_END-2 is stored in last 2B (big endian)
+Range is taken from build_flags in "platformio.ini", i.e. same as in "src/main.c".
+Checksum method must match fletcher16_chk_range() / checksum_task_init() in "src/main.c".
+
+@author: gicking @ Github
+"""
+
+import os
+import sys
+
+Import("env")
+
+# import tool from checksum library
+sys.path.insert(0, os.path.join(env.subst("$PROJECT_DIR"), "..", "common", "checksum", "test_checksums"))
+import add_checksum
+
+
+# get numerical value of define from build_flags, e.g. -DCHK_ADDR_START=0x8000
+def get_define(Name):
+    for define in env.get("CPPDEFINES", []):
+        if isinstance(define, (list, tuple)) and (define[0] == Name):
+            return int(str(define[1]), 0)
+    sys.stderr.write("post_checksum.py: %s not defined in build_flags\n" % Name)
+    env.Exit(1)
+
+
+# post-build action: patch linker output
+def patch_firmware(source, target, env):
+    filename = target[0].get_abspath()
+    start = get_define("CHK_ADDR_START")
+    end = get_define("CHK_ADDR_END")
+    chk = add_checksum.add_checksum(filename, Start=start, End=end, Method="fletcher16", Fill=0x75)
+    print("fletcher16 0x%04x over 0x%x..0x%x stored at 0x%x" % (chk, start, end - 2, end - 1))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}${PROGSUFFIX}", patch_firmware)
@@ -1,28 +1,32 @@
 /**********************
   
   Demonstrate flash Fletcher-16 checksum check.
-  Note: safer CRC16 is also available in 'common/checksum', but it is ~3x slower
+  Note: safer CRC16 is also available in 'common/checksum'. Bitwise CRC16 is ~3x slower,
+  for faster table-driven CRC16 see CRC16_CCITT_IMPL in "platformio.ini"
 
   Functionality:
-    - during initialization calculate checksum over complete flash
-    - in main loop periodically 
-      - blink LED
-      - calculate checksum over complete flash in background
+    - during initialization calculate checksum over complete flash (Fletcher-16 and CRC16 for comparison)
+      and compare Fletcher-16 with reference checksum stored in last 2B of flash
+    - in main loop periodically call tasks via scheduler (see "scheduler.h")
+      - 1ms: calculate checksum over complete flash in background, with a time budget per 1ms, and compare with reference
+      - 500ms: blink LED
+      - 10s: print scheduler and profiling statistics
 
   Supported Hardware:
     - Nucleo 8S207K8
   
   Note:
-    - here only print calculated checksum, no comparison with stored value in EEPROM
-    - checksum calculation is not size or speed optimized
-    - the initial Fletcher-16 checksum calculation takes ~330ms (16MHz, SDCC)
-    - when called every 1ms, a new checksum is available every ~65s with an additional CPU load of ~0.8% (16MHz, SDCC)
+    - reference checksum is calculated after build by "post_checksum.py", which also fills unused flash with 0x75
+      (illegal opcode -> reset on code runaway). Range is set via CHK_ADDR_START/CHK_ADDR_END in "platformio.ini"
+    - on checksum mismatch here only an error is printed. The correct error reaction depends on the application
+    - the initial Fletcher-16 checksum calculation took ~330ms (16MHz, SDCC) with 2 modulo operations per byte.
+      fletcher16_chk_range() now reduces modulo 255 only every FLETCHER16_BLOCK_MAX bytes, see printed runtime
+    - previously 1B was checked every 1ms, i.e. a new checksum was available only every ~65s
+    - now each 1ms call uses CHK_BUDGET us, i.e. CPU load is ~CHK_BUDGET/10 %. Pass duration (= fault detection time) is printed
+    - runtimes are profiled with TIM2 cycle counter (see "perf_counter.h"), which resolves single bytes. Disable via PERF_ENABLE in "platformio.ini"
 
 **********************/
 
-/*----------------------------------------------------------
-    INCLUDE FILES
-----------------------------------------------------------*/
 /*----------------------------------------------------------
     INCLUDE FILES
 ----------------------------------------------------------*/
@@ -35,6 +39,10 @@
   #include "sw_clock.h"
   #include "uart_stdio.h"
   #include "checksum_fletcher16.h"
+  #include "checksum_crc16.h"
+  #include "checksum_task.h"
+  #include "scheduler.h"
+  #include "perf_counter.h"
 #undef _MAIN_
 
 
@@ -53,29 +61,119 @@
 // LED blink period [ms]
 #define LED_PERIOD      500
 
+// period for printing scheduler statistics [ms]
+#define STATS_PERIOD    10000
+
 // communication speed [Baud]
 #define BAUDRATE        115200L
 
-// start/end address for checksum check
-#define CHK_ADDR_START  0x8000    // flash start address
-#define CHK_ADDR_END    0x17FFF   // flash end address (64kB)
+// start/end address for checksum check incl. reference checksum. Set in "platformio.ini", also used by "post_checksum.py"
+#if !defined(CHK_ADDR_START) || !defined(CHK_ADDR_END)
+  #error define CHK_ADDR_START and CHK_ADDR_END in platformio.ini
+#endif
+#define CHK_ADDR_STORED (CHK_ADDR_END-1)      // reference checksum (2B, big endian) in last 2B of range
+#define CHK_ADDR_LAST   (CHK_ADDR_STORED-1)   // last address covered by checksum
+
+// time budget for background checksum per 1ms [us]
+#define CHK_BUDGET      100
+
+// profiling ids for PERF_BEGIN()/PERF_END() [cycles]
+#define PERF_FLETCHER16   0       // initial Fletcher-16 over flash
+#define PERF_CRC16        1       // initial CRC16 over flash
+#define PERF_FLETCHER_1B  2       // Fletcher-16 update for single byte
+#define PERF_CHK_TASK     3       // background checksum step
 
 
 /*----------------------------------------------------------
     GLOBAL FUNCTIONS
 ----------------------------------------------------------*/
 
+void task_checksum(void);
+void task_LED(void);
+void task_stats(void);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// context of background checksum calculation
+checksum_task_t   taskChk;
+
+// static task table for scheduler: function, period [ms], offset [ms], budget [us]. Order = priority
+sched_task_t      tasks[] = {
+  { task_checksum, 1,            0, CHK_BUDGET+50 },
+  { task_LED,      LED_PERIOD,   0, 50 },
+  { task_stats,    STATS_PERIOD, 5, 20000 }
+};
+#define NUM_TASKS   (sizeof(tasks)/sizeof(sched_task_t))
+
+
+/////////////////
+// task: continue background checksum
+/////////////////
+void task_checksum(void)
+{
+  bool  finished;
+
+  // continue background checksum for max. CHK_BUDGET us. Returns TRUE if checksum calculation is finished
+  PERF_BEGIN(PERF_CHK_TASK);
+  finished = checksum_task_run(&taskChk, CHK_BUDGET);
+  PERF_END(PERF_CHK_TASK);
+
+  if (finished == TRUE)
+  {
+    //////
+    // compare calculated checksum with reference checksum stored in flash
+    //////
+    
+    // here just print checksum, pass duration and result
+    printf("background: 0x%04x\t%ldms\t%s\n", taskChk.result, (long) taskChk.duration,
+      (taskChk.result == read_2B_far(CHK_ADDR_STORED)) ? "ok" : "error");
+    
+  } // if checksum finished
+
+} // task_checksum()
+
+
+
+/////////////////
+// task: blink LED
+/////////////////
+void task_LED(void)
+{
+  GPIO_WriteReverse(PORT_TEST, PIN_LED);
+
+} // task_LED()
+
+
+
+/////////////////
+// task: print scheduler statistics
+/////////////////
+void task_stats(void)
+{
+  uint8_t   i;
+
+  printf("task\truns\toverrun\tbudget\tjitter\texec\n");
+  for (i = 0; i < NUM_TASKS; i++)
+    printf("%d\t%ld\t%d\t%d\t%dus\t%dus\n", (int) i, (long) tasks[i].runs, (int) tasks[i].overruns, 
+      (int) tasks[i].budgetMiss, (int) tasks[i].jitterMax, (int) tasks[i].execMax);
+
+  // profiling statistics [cycles]
+  perf_print();
+
+} // task_stats()
+
+
+
 /////////////////
 //  main routine
 /////////////////
 void main(void)
 {
-  // for SW scheduler
-  uint32_t  lastLED=0;
-
-  // for checksum calculation
-  uint32_t  addrChk;
-  uint16_t  Chk;
+  // for initial checksum calculation
+  uint16_t          Chk;
 
 
   /////////////
@@ -106,16 +204,35 @@ void main(void)
   // enable interrupts
   enableInterrupts();
 
+  // start TIM2 cycle counter for profiling
+  perf_init();
+
   // initial checksum calculation
   uint32_t tStart = millis();
-  Chk = fletcher16_chk_range(CHK_ADDR_START, CHK_ADDR_END);
+  PERF_BEGIN(PERF_FLETCHER16);
+  Chk = fletcher16_chk_range(CHK_ADDR_START, CHK_ADDR_LAST);
+  PERF_END(PERF_FLETCHER16);
   uint32_t tEnd = millis();
-  printf("initial: %ldms\t0x%04x\n", (long) (tEnd-tStart), Chk);
+  printf("initial: %ldms\t0x%04x\t%s\n", (long) (tEnd-tStart), Chk, (Chk == read_2B_far(CHK_ADDR_STORED)) ? "ok" : "error");
 
-  // re-initialize checksum calculation
-  addrChk = CHK_ADDR_START;
-  Chk = fletcher16_chk_initialize();
+  // initial CRC16 calculation for runtime comparison (see CRC16_CCITT_IMPL)
   tStart = millis();
+  PERF_BEGIN(PERF_CRC16);
+  Chk = crc16_ccitt_range(CHK_ADDR_START, CHK_ADDR_LAST);
+  PERF_END(PERF_CRC16);
+  tEnd = millis();
+  printf("CRC16 (impl %d): %ldms\t0x%04x\n", (int) CRC16_CCITT_IMPL, (long) (tEnd-tStart), Chk);
+
+  // runtime of single byte Fletcher-16 update, see fletcher16_chk_update()
+  PERF_BEGIN(PERF_FLETCHER_1B);
+  Chk = fletcher16_chk_update(Chk, 0x55);
+  PERF_END(PERF_FLETCHER_1B);
+
+  // initialize background checksum calculation
+  checksum_task_init(&taskChk, CHK_FLETCHER16, CHK_ADDR_START, CHK_ADDR_LAST);
+
+  // start scheduler
+  scheduler_init(tasks, NUM_TASKS);
 
 
   /////////////
@@ -123,45 +240,8 @@ void main(void)
   /////////////
   while (1)
   {
-    // check if 1ms has passed
-    if (g_flagMilli)
-    {
-      g_flagMilli = FALSE;
-    
-
-      // update checksum value
-      Chk = fletcher16_chk_update(Chk, read_1B_far(addrChk));
-
-      // if checksum calculation is finished
-      if (++addrChk > CHK_ADDR_END)
-      {
-        // perform final update (here dummy)
-        Chk = fletcher16_chk_finalize(Chk);
-        
-        //////
-        // compare calculated checksum with stored checksum from D-flash 
-        //////
-        
-        // here just print checksum...
-        printf("background: 0x%04x\n", Chk);
-        
-        // re-start checksum calculation
-        addrChk = CHK_ADDR_START;
-        Chk = fletcher16_chk_initialize();
-
-      } // if addrChk > CHK_ADDR_END
-      
-
-      // task for LED blink
-      if (millis() - lastLED >= LED_PERIOD)
-      {
-        lastLED = millis();
-
-        GPIO_WriteReverse(PORT_TEST, PIN_LED);
-        
-      } // task LED
-
-    } // if g_flagMilli
+    // execute released tasks
+    scheduler_dispatch();
 
   } // main loop
   
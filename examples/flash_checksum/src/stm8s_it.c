@@ -28,6 +28,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm8s_it.h"
 #include "sw_clock.h"
+#include "scheduler.h"
+#include "perf_counter.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -269,9 +271,9 @@ INTERRUPT_HANDLER(TIM1_CAP_COM_IRQHandler, 12)
   */
  INTERRUPT_HANDLER(TIM2_UPD_OVF_BRK_IRQHandler, 13)
 {
-  /* In order to detect unexpected events during development,
-     it is recommended to set a breakpoint on the following instruction.
-  */
+  // call inline ISR handler from perf_counter.h
+  ISR_TIM2_handler();
+
 }
 
 /**
@@ -460,6 +462,9 @@ INTERRUPT_HANDLER(TIM4_UPD_OVF_IRQHandler, 23)
   // call inline ISR handler from sw_clock.h
   ISR_TIM4_handler();
 
+  // release scheduler tasks (after SW clock update)
+  ISR_scheduler_tick();
+
 }
 #endif /*STM8S903*/
 
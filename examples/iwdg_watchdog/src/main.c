@@ -8,7 +8,7 @@
       - configure IWDG (20ms timeout)
       - configure LED pin to output
       - initialize SW clock
-      - configure UART @ 115.2kBaud / 8N1 
+      - configure UART @ 115.2kBaud / 8N1 with interrupt driven RX buffer
       - print reset source via UART
       - blocking wait 1s (with dummy IWDG service)
     - main loop
@@ -178,6 +178,11 @@ void main(void)
   g_UART_ReceiveData8 = &UART3_ReceiveData8;
   g_UART_GetFlagStatus = &UART3_GetFlagStatus;
 
+  // enable RX interrupt for RX buffer. Else bytes are lost if main loop takes longer than 1 character
+  #if (UART_RX_BUFFER_SIZE > 0)
+    UART3_ITConfig(UART3_IT_RXNE_OR, ENABLE);
+  #endif
+
   // enable interrupts
   enableInterrupts();
 
@@ -238,9 +243,9 @@ void main(void)
 
 
     // if byte received from serial monitor
-    if (UART3_GetFlagStatus(UART3_FLAG_RXNE))
+    if (uart_available())
     {
-      char c = getchar();
+      char c = (char) uart_read();
       
       // if 'i' received, disable IWDG service --> reset
       if (c == 'i')
@@ -28,6 +28,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm8s_it.h"
 #include "sw_clock.h"
+#include "uart_stdio.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -399,10 +400,10 @@ INTERRUPT_HANDLER(I2C_IRQHandler, 19)
   */
  INTERRUPT_HANDLER(UART3_RX_IRQHandler, 21)
 {
-    /* In order to detect unexpected events during development,
-       it is recommended to set a breakpoint on the following instruction.
-    */
-  }
+  // call inline ISR handler from uart_stdio.h
+  ISR_UART_RX_handler();
+
+}
 #endif /*STM8S208 or STM8S207 or STM8AF52Ax or STM8AF62Ax */
 
 #if defined(STM8S207) || defined(STM8S007) || defined(STM8S208) || defined (STM8AF52Ax) || defined (STM8AF62Ax)
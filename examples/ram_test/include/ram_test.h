@@ -37,14 +37,102 @@
 // function returns, it returns directly from __sdcc_external_startup() instead.
 #ifdef __SDCC_MODEL_LARGE
   #define ram_test_checkerboard() do { __asm__("jpf _ram_test_checkerboard_impl"); } while(0)
-  //#define ram_test_march_c() do { __asm__("jpf _ram_test_march_c_impl"); } while(0)
+  #define ram_test_march_c() do { __asm__("jpf _ram_test_march_c_impl"); } while(0)
+  #define ram_test_checkerboard_fast() do { __asm__("jpf _ram_test_checkerboard_fast_impl"); } while(0)
 #else
   #define ram_test_checkerboard() do { __asm__("jp _ram_test_checkerboard_impl"); } while(0)
-  //#define ram_test_march_c() do { __asm__("jp _ram_test_march_c_impl"); } while(0)
+  #define ram_test_march_c() do { __asm__("jp _ram_test_march_c_impl"); } while(0)
+  #define ram_test_checkerboard_fast() do { __asm__("jp _ram_test_checkerboard_fast_impl"); } while(0)
+#endif
+
+// Select test via project option: RAM_TEST_MARCH_C for March C- (slower, also
+// detects address decoder and coupling faults), RAM_TEST_FAST for checkerboard
+// test with 16-bit access @ 16MHz (fastest), else checkerboard test.
+#if defined(RAM_TEST_MARCH_C) && defined(RAM_TEST_FAST)
+  #error RAM_TEST_FAST is only available for checkerboard test
+#endif
+#ifdef RAM_TEST_MARCH_C
+  #define ram_test() ram_test_march_c()
+#elif defined(RAM_TEST_FAST)
+  #define ram_test() ram_test_checkerboard_fast()
+#else
+  #define ram_test() ram_test_checkerboard()
+#endif
+
+// Optionally service IWDG and WWDG inside the test every RAM_TEST_WDG_CHUNK
+// bytes (RAM_END+1 must be a multiple). Required if the test takes longer than
+// the watchdog timeouts, e.g. for large RAM or slow boot clock. The return
+// address is then kept in SP, which is set to its reset value RAM_END after
+// the test.
+#if defined(RAM_TEST_WDG_CHUNK) && defined(RAM_TEST_FAST)
+  #error RAM_TEST_WDG_CHUNK is not supported (and not required) for RAM_TEST_FAST
+#endif
+#if defined(RAM_TEST_FAST) && (((RAM_END + 1L) % 16) != 0)
+  #error RAM_TEST_FAST requires RAM_END+1 to be a multiple of 16
+#endif
+#ifdef RAM_TEST_WDG_CHUNK
+  #if (RAM_TEST_WDG_CHUNK < 1) || (((RAM_END + 1L) % RAM_TEST_WDG_CHUNK) != 0)
+    #error RAM_END+1 must be a multiple of RAM_TEST_WDG_CHUNK
+  #endif
+#endif
+
+// CPU clock during test [Hz]. Default is reset clock HSI/8, or HSI for
+// RAM_TEST_FAST
+#ifndef RAM_TEST_FCPU
+  #ifdef RAM_TEST_FAST
+    #define RAM_TEST_FCPU 16000000L
+  #else
+    #define RAM_TEST_FCPU 2000000L
+  #endif
+#endif
+
+// Watchdog timeouts during test [ms]. IWDG is set to 255ms before the test
+// (see main.c), WWDG timeout after reset is 12288*64 CPU cycles (393ms @ 2MHz).
+// Set to 0 if the respective watchdog is not started via option bytes.
+#ifndef RAM_TEST_IWDG_MS
+  #define RAM_TEST_IWDG_MS 255
+#endif
+#ifndef RAM_TEST_WWDG_MS
+  #define RAM_TEST_WWDG_MS (786432000L / RAM_TEST_FCPU)
+#endif
+
+// CPU cycles per byte for complete test and, with RAM_TEST_WDG_CHUNK, max.
+// cycles per byte of a single loop (= between two watchdog services).
+// Calculated from instruction cycles (not measured), see ram_test_*.c
+#if defined(RAM_TEST_MARCH_C) && defined(RAM_TEST_WDG_CHUNK)
+  #define RAM_TEST_CYCLES 39
+  #define RAM_TEST_CYCLES_ELEMENT 7
+#elif defined(RAM_TEST_MARCH_C)
+  #define RAM_TEST_CYCLES 37
+#elif defined(RAM_TEST_FAST)
+  #define RAM_TEST_CYCLES 6
+#elif defined(RAM_TEST_WDG_CHUNK)
+  #define RAM_TEST_CYCLES 22
+  #define RAM_TEST_CYCLES_ELEMENT 6
+#else
+  #define RAM_TEST_CYCLES 18
+#endif
+
+// Calculated duration of complete test and max. time between two watchdog
+// services [ms], rounded up
+#define RAM_TEST_DURATION_MS (((RAM_END + 1L) * RAM_TEST_CYCLES + RAM_TEST_FCPU / 1000 - 1) / (RAM_TEST_FCPU / 1000))
+#ifdef RAM_TEST_WDG_CHUNK
+  #define RAM_TEST_WDG_INTERVAL_MS ((RAM_TEST_WDG_CHUNK * 1L * RAM_TEST_CYCLES_ELEMENT + RAM_TEST_FCPU / 1000 - 1) / (RAM_TEST_FCPU / 1000))
+#else
+  #define RAM_TEST_WDG_INTERVAL_MS RAM_TEST_DURATION_MS
+#endif
+
+// Fail build if a watchdog would expire during the test
+#if (RAM_TEST_IWDG_MS > 0) && (RAM_TEST_WDG_INTERVAL_MS >= RAM_TEST_IWDG_MS)
+  #error RAM test exceeds IWDG timeout. Use (smaller) RAM_TEST_WDG_CHUNK or longer IWDG timeout
+#endif
+#if (RAM_TEST_WWDG_MS > 0) && (RAM_TEST_WDG_INTERVAL_MS >= RAM_TEST_WWDG_MS)
+  #error RAM test exceeds WWDG timeout. Use (smaller) RAM_TEST_WDG_CHUNK
 #endif
 
 // WARNING: DO NOT CALL THESE FUNCTIONS DIRECTLY. USE THE MACROS ABOVE.
 extern unsigned char ram_test_checkerboard_impl(void);
-//extern unsigned char ram_test_march_c_impl(void);
+extern unsigned char ram_test_march_c_impl(void);
+extern unsigned char ram_test_checkerboard_fast_impl(void);
 
 #endif
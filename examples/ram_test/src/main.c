@@ -1,10 +1,15 @@
 /**********************
   
-  Demonstrate RAM test during flash startup
+  Demonstrate RAM test during flash startup and during run-time
 
   Functionality:
-    - during startup perform RAM test (checkerboard or march-c)
+    - during startup perform RAM test (checkerboard, fast checkerboard or March C-, select via [env] with RAM_TEST_FAST or
+      RAM_TEST_MARCH_C in "platformio.ini". RAM_TEST_NONE skips the test, e.g. as baseline for measurement, see "Readme.txt")
     - handle IWDG and WWDG watchdogs (important if WDs are activated via option bytes)
+    - in main loop periodically call tasks via scheduler (see "scheduler.h")
+      - 1ms: transparent run-time RAM test of one block (see "ram_test_task.h")
+      - 10ms: scan painted stack for high-water mark, and reset on guard band write (see "stack_monitor.h")
+      - 500ms: blink LED
     - in case of
       - no RAM error blink LED periodically 
       - RAM error perform ILLOP reset
@@ -17,6 +22,9 @@
     - This implementation is SDCC specific. Other toolchains need adaptations
     - Requires SDCC version >=4.2.10, see https://sourceforge.net/p/sdcc/bugs/3520/ and https://sourceforge.net/p/sdcc/bugs/3533/#7b22
     - RAM size must be provided via project options, see file "platformio.ini"
+    - run-time test disables interrupts for RAM_TEST_BLOCK_CYCLES per block (~60us for 16B @ 16MHz).
+      Full coverage period is (RAM_END+1)/RAM_TEST_BLOCK ms, e.g. 384ms for 6kB, see taskRam.duration
+    - stack size for monitor is set via STACK_SIZE in "platformio.ini". Max. stack usage is stored in taskStack.used
 
 **********************/
 
@@ -28,6 +36,13 @@
 #include "stm8s_gpio.h"
 #include "stdio.h"
 #include "ram_test.h"
+#define _MAIN_            // required for global variables
+  #include "sw_clock.h"
+  #include "scheduler.h"
+  #include "ram_test_task.h"
+  #include "sw_reset.h"
+  #include "stack_monitor.h"
+#undef _MAIN_
 
 
 /*----------------------------------------------------------
@@ -47,13 +62,50 @@
   #error parameter RAM_END must be specified via project options or Makefile
 #endif
 
+// LED blink period [ms]
+#define LED_PERIOD      500
+
+// number of RAM blocks tested per 1ms
+#define RAM_BLOCKS      1
+
+// period [ms] and number of bytes per scan of stack monitor
+#define STACK_PERIOD    10
+#define STACK_BYTES     32
+
 /*----------------------------------------------------------
     GLOBAL FUNCTIONS
 ----------------------------------------------------------*/
 
+void task_ram_test(void);
+void task_stack(void);
+void task_LED(void);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// context of run-time RAM test
+ram_test_task_t   taskRam;
+
+// context of stack monitor
+stack_monitor_t   taskStack;
+
+// static task table for scheduler: function, period [ms], offset [ms], budget [us]. Order = priority
+sched_task_t      tasks[] = {
+  { task_ram_test, 1,            0, 100*RAM_BLOCKS },
+  { task_stack,    STACK_PERIOD, 3, 50 },
+  { task_LED,      LED_PERIOD,   0, 50 }
+};
+#define NUM_TASKS   (sizeof(tasks)/sizeof(sched_task_t))
+
+
 uint8_t __sdcc_external_startup(void)
 {
-  // Note: checkerboard test takes ~55ms for 6kB @ fCPU = 2MHz
+  // Note: calculated duration for 6kB @ fCPU = 2MHz is ~55ms for checkerboard and ~114ms for March C- test.
+  // Fast checkerboard test (RAM_TEST_FAST) takes ~2.3ms @ 16MHz (calculated) and restores the reset clock afterwards.
+  // For measurement in simulator see "Readme.txt"
+  // Estimated duration vs. watchdog timeouts is checked at build time, see RAM_TEST_DURATION_MS in ram_test.h
 
   // If IWDG is started via option byte, it is started with typ. 16ms timeout.
   // To avoid reset during RAM test, set a longer IWDG timeout.
@@ -61,25 +113,65 @@ uint8_t __sdcc_external_startup(void)
   //IWDG->KR  = 0xCC;     // start IWDG (not required if IWDG is activated via option bytes)
   IWDG->KR  = 0x55;     // unlock write access to protected registers
   IWDG->PR  = 0x04;     // set prescaler for 1kHz (=64kHz/2^(PR+2))
-  IWDG->RLR = 0xFF;     // set max. timeout period (255ms @ 1kHz)
+  IWDG->RLR = 0xFF;     // set max. timeout period (255ms @ 1kHz). Must match RAM_TEST_IWDG_MS in ram_test.h
   IWDG->KR  = 0xAA;     // reload IWDG with new timeout 
 
   // If WWDG is started via option byte, it is started with 393.6ms timeout @ fCPU=2MHz.
-  // That is sufficient for both checkerboard and march-c tests, so no WWDG handling 
-  // is required here, just take into account the test duration for your initial WWDG service
+  // That is sufficient for both checkerboard and march-c tests with 6kB, so no WWDG handling 
+  // is required here, just take into account the test duration for your initial WWDG service.
+  // For larger RAM or slower clock service IWDG and WWDG within the test via RAM_TEST_WDG_CHUNK
 
   // These are actually macros that jump directly to the test routine. When
   // that returns, this means it effectively does so directly from
   // __sdcc_external_startup() itself. Anything below the test is never
   // executed; the 'return' statement is just to avoid a compiler warning.
-  ram_test_checkerboard();
+  // Test algorithm is selected via RAM_TEST_MARCH_C, see "ram_test.h"
+  #if !defined(RAM_TEST_NONE)
+    ram_test();
+  #endif
 
-  // just to avoid compiler warning
+  // only reached for RAM_TEST_NONE, else just to avoid compiler warning. 0 = initialize variables in GSINIT
   return 0;
 
 } // __sdcc_external_startup()
 
 
+
+/////////////////
+// task: test next RAM block(s)
+/////////////////
+void task_ram_test(void)
+{
+  // on RAM error perform ILLOP reset. Correct error reaction depends on the application
+  if (ram_test_task_run(&taskRam, RAM_BLOCKS) == RAM_TEST_ERROR)
+    SW_RESET_ILLOP();
+
+} // task_ram_test()
+
+
+
+/////////////////
+// task: check stack guard band and scan for high-water mark
+/////////////////
+void task_stack(void)
+{
+  // on stack overflow perform ILLOP reset (in library). Max. stack usage is stored in taskStack.used
+  stack_monitor_run(&taskStack, STACK_BYTES);
+
+} // task_stack()
+
+
+
+/////////////////
+// task: blink LED
+/////////////////
+void task_LED(void)
+{
+  GPIO_WriteReverse(PORT_TEST, PIN_LED);
+
+} // task_LED()
+
+
 /////////////////
 //  main routine
 /////////////////
@@ -89,24 +181,45 @@ void main(void)
   // initialization
   /////////////
 
+  // fill unused stack with pattern, directly after startup RAM test
+  stack_paint();
+
+  // disable interrupts
+  disableInterrupts();
+
+  // set HSI and HSE prescaler to 1 and fCPU=fMaster
+  CLK->CKDIVR = 0x00;
+
   // Configure LED pin as output
   GPIO_Init(PORT_TEST, PIN_LED, GPIO_MODE_OUT_PP_LOW_FAST);
 
+  // start 1ms clock via TIM4
+  init_SW_clock();
+
+  // enable interrupts
+  enableInterrupts();
+
+  // initialize run-time RAM test over complete RAM incl. stack
+  ram_test_task_init(&taskRam, 0x0000, RAM_END);
+
+  // initialize stack monitor
+  stack_monitor_init(&taskStack);
+
+  // start scheduler
+  scheduler_init(tasks, NUM_TASKS);
+
 
   /////////////
   // main loop
   /////////////
   while (1)
   {
-    // toggle LED
-    GPIO_WriteReverse(PORT_TEST, PIN_LED);
-      
-    // dummy wait
-    for (uint32_t i=0; i<50000L; i++)
-    {
-      IWDG->KR  = 0xAA;   // service IWDG watchdog
-      WWDG->CR  = 0x7F;   // service WWDG watchdog
-    }
+    // execute released tasks
+    scheduler_dispatch();
+
+    // service watchdogs
+    IWDG->KR  = 0xAA;   // service IWDG watchdog
+    WWDG->CR  = 0x7F;   // service WWDG watchdog
 
   } // main loop
   
@@ -28,7 +28,7 @@
 
 #include "ram_test.h"
 
-// 30 bytes
+// 30 bytes (with RAM_TEST_WDG_CHUNK: 75 bytes)
 unsigned char ram_test_checkerboard_impl(void) __naked {
 	__asm
 #ifdef __SDCC_MODEL_LARGE
@@ -44,6 +44,15 @@ unsigned char ram_test_checkerboard_impl(void) __naked {
 		popw y
 #endif
 
+#ifdef RAM_TEST_WDG_CHUNK
+		; Move return address to SP (stack is not used during test), and use Y
+		; as down-counter for servicing the watchdogs every RAM_TEST_WDG_CHUNK
+		; bytes. As RAM_END+1 is a multiple of the chunk size, chunk and RAM
+		; end are reached at the same time.
+		ldw sp, y
+		ldw y, #RAM_TEST_WDG_CHUNK
+#endif
+
 		; Start off initially with checkerboard pattern 0x55 (0b01010101).
 		ld a, #0x55
 
@@ -54,6 +63,16 @@ unsigned char ram_test_checkerboard_impl(void) __naked {
 		; Fill entire RAM with test pattern.
 		ld (x), a
 		decw x
+#ifdef RAM_TEST_WDG_CHUNK
+		decw y
+		jrne 0002$
+
+		; Service IWDG and WWDG after each chunk. Only SFRs are written.
+		mov 0x50E0, #0xAA
+		mov 0x50D1, #0x7F
+		ldw y, #RAM_TEST_WDG_CHUNK
+		tnzw x
+#endif
 		jrpl 0002$
 
 		;;;;;;;;;;;;
@@ -69,6 +88,15 @@ unsigned char ram_test_checkerboard_impl(void) __naked {
 		cp a, (x)
 		jrne 9999$
 		decw x
+#ifdef RAM_TEST_WDG_CHUNK
+		decw y
+		jrne 0003$
+
+		mov 0x50E0, #0xAA
+		mov 0x50D1, #0x7F
+		ldw y, #RAM_TEST_WDG_CHUNK
+		tnzw x
+#endif
 		jrpl 0003$
 
 		; Invert the pattern. When bit 7 is set - i.e. it becomes 0xAA
@@ -77,6 +105,14 @@ unsigned char ram_test_checkerboard_impl(void) __naked {
 		cpl a
 		jrmi 0001$
 
+#ifdef RAM_TEST_WDG_CHUNK
+		; Get return address back from SP and set SP to its reset value, which
+		; is the value when GSINIT calls us (SDCC doesn't initialize SP).
+		ldw y, sp
+		ldw x, #RAM_END
+		ldw sp, x
+#endif
+
 #ifdef __SDCC_MODEL_LARGE
 		; We previously only saved the 2 LSBs of the return address, so restore
 		; the MSB to a fixed value of zero, then do a far return.
@@ -0,0 +1,170 @@
+/*******************************************************************************
+ *
+ * ram_test_march_c.c - March C- RAM test implementation
+ * 
+ * same interface and startup handling as ram_test_checkerboard.c from
+ * https://github.com/basilhussain/stm8-ram-test
+ *
+ * March C- sequence (10n operations, n = RAM size):
+ *   up/down(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); up/down(r0)
+ * Detects stuck-at, transition, address decoder and most coupling faults
+ * between different bytes. Bytes are written as 0x00/0xFF, i.e. coupling
+ * between bits of the same byte is not covered (see checkerboard test).
+ *
+ * Runtime (calculated from instruction cycles, not measured): 37 cycles per
+ * byte vs. 18 for checkerboard, i.e. ~114ms for 6kB @ fCPU = 2MHz
+ * (checkerboard ~55ms).
+ * With watchdog service every RAM_TEST_WDG_CHUNK bytes 39 cycles per byte,
+ * see ram_test.h. Measure in simulator via env nucleo_8s207k8_march_c, see
+ * Readme.txt.
+ *
+ ******************************************************************************/
+
+#include "ram_test.h"
+
+// 50 bytes (large memory model: 53 bytes, with RAM_TEST_WDG_CHUNK: 128 bytes)
+unsigned char ram_test_march_c_impl(void) __naked {
+	__asm
+#ifdef __SDCC_MODEL_LARGE
+		; Return address on stack is 3 bytes, but because GSINIT section (where
+		; we are called from) will always reside very near start of flash at
+		; 0x8000, the MSB will always be zero (e.g. 0x0080nn) and can be
+		; discarded, leaving only the two LSBs to be saved in Y reg.
+		pop a
+		popw y
+#else
+		; Save the 16-bit return address from the stack in Y reg, because
+		; otherwise it will be overwritten.
+		popw y
+#endif
+
+#ifdef RAM_TEST_WDG_CHUNK
+		; Move return address to SP (stack is not used during test), and use Y
+		; as down-counter for servicing the watchdogs every RAM_TEST_WDG_CHUNK
+		; bytes. As RAM_END+1 is a multiple of the chunk size, each march
+		; element ends together with a chunk, i.e. Y needs no reload there.
+		ldw sp, y
+		ldw y, #RAM_TEST_WDG_CHUNK
+#endif
+
+		; M0: write 0x00 to all RAM bytes (any order). A holds the expected
+		; value for the following march elements.
+		clr a
+		ldw x, #RAM_END
+
+	0001$:
+		ld (x), a
+		decw x
+#ifdef RAM_TEST_WDG_CHUNK
+		decw y
+		jrne 0001$
+
+		; Service IWDG and WWDG after each chunk. Only SFRs are written.
+		mov 0x50E0, #0xAA
+		mov 0x50D1, #0x7F
+		ldw y, #RAM_TEST_WDG_CHUNK
+		tnzw x
+#endif
+		jrpl 0001$
+
+		;;;;;;;;;;;;
+		; TEST ONLY: provoke RAM error -> permanent reset cycle!
+		;;;;;;;;;;;;
+		;;;bset 0x0010, #7
+
+		; M1 (A=0x00) and M2 (A=0xFF): ascending addresses, read expected
+		; value and write its inverse. CPL (x) performs the write in a single
+		; cycle, because the read value is known to be equal to A.
+	0002$:
+		clrw x
+
+	0003$:
+		cp a, (x)
+		jrne 9999$
+		cpl (x)
+		incw x
+#ifdef RAM_TEST_WDG_CHUNK
+		; The chunk counter replaces the end check, which is only required
+		; after each chunk.
+		decw y
+		jrne 0003$
+
+		mov 0x50E0, #0xAA
+		mov 0x50D1, #0x7F
+		ldw y, #RAM_TEST_WDG_CHUNK
+#endif
+		cpw x, #RAM_END+1
+		jrne 0003$
+
+		; Invert expected value. After M1 (A becomes 0xFF) go back for M2,
+		; after M2 (A is 0x00 again) continue.
+		cpl a
+		jrmi 0002$
+
+		; M3 (A=0x00) and M4 (A=0xFF): same with descending addresses.
+	0004$:
+		ldw x, #RAM_END
+
+	0005$:
+		cp a, (x)
+		jrne 9999$
+		cpl (x)
+		decw x
+#ifdef RAM_TEST_WDG_CHUNK
+		decw y
+		jrne 0005$
+
+		mov 0x50E0, #0xAA
+		mov 0x50D1, #0x7F
+		ldw y, #RAM_TEST_WDG_CHUNK
+		tnzw x
+#endif
+		jrpl 0005$
+
+		cpl a
+		jrmi 0004$
+
+		; M5: read back 0x00 from all RAM bytes (any order).
+		ldw x, #RAM_END
+
+	0006$:
+		cp a, (x)
+		jrne 9999$
+		decw x
+#ifdef RAM_TEST_WDG_CHUNK
+		decw y
+		jrne 0006$
+
+		mov 0x50E0, #0xAA
+		mov 0x50D1, #0x7F
+		ldw y, #RAM_TEST_WDG_CHUNK
+		tnzw x
+#endif
+		jrpl 0006$
+
+#ifdef RAM_TEST_WDG_CHUNK
+		; Get return address back from SP and set SP to its reset value, which
+		; is the value when GSINIT calls us (SDCC doesn't initialize SP).
+		ldw y, sp
+		ldw x, #RAM_END
+		ldw sp, x
+#endif
+
+		; A is 0x00 here, which is also the return value.
+#ifdef __SDCC_MODEL_LARGE
+		; We previously only saved the 2 LSBs of the return address, so restore
+		; the MSB to a fixed value of zero, then do a far return.
+		pushw y
+		push #0x00
+		retf
+#else
+		; Put the return address back on to the stack and return.
+		pushw y
+		ret
+#endif
+
+	9999$:
+		; Upon failure, perform a software reset by executing an illegal opcode.
+		.db 0x75
+	__endasm;
+}
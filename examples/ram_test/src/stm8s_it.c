@@ -27,6 +27,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm8s_it.h"
+#include "sw_clock.h"
+#include "scheduler.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -456,9 +458,12 @@ INTERRUPT_HANDLER(TIM6_UPD_OVF_TRG_IRQHandler, 23)
   */
 INTERRUPT_HANDLER(TIM4_UPD_OVF_IRQHandler, 23)
 {
-  /* In order to detect unexpected events during development,
-     it is recommended to set a breakpoint on the following instruction.
-  */
+  // call inline ISR handler from sw_clock.h
+  ISR_TIM4_handler();
+
+  // release scheduler tasks (after SW clock update)
+  ISR_scheduler_tick();
+
 }
 #endif /*STM8S903*/
 
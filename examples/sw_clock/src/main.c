@@ -1,22 +1,23 @@
 /**********************
   
-  Simple SW clock & scheduler (for convenience)
+  Simple SW clock & SW timers (for convenience)
 
   Functionality:
     - initialization:
       - configure LED pin to output
-      - initialize SW clock
+      - initialize SW clock and SW timer wheel
     - main loop
-      - periodically:
-        - blink LED
-        - generate long pulse on test pin 1
-        - generate short pulse on test pin 2
+      - periodically (via SW timers, see "sw_timer.h"):
+        - blink LED (callback from TIM4 ISR)
+        - generate long pulse on test pin 1 (deferred callback, low power sleep)
+        - generate short pulse on test pin 2 (deferred callback)
 
   Functionality:
     - set HSI prescaler to 16MHz (default is 2MHz) 
     - blink LED (=D13) every 500ms
-    - periodically generate 1ms high pulse on testpin D5
+    - periodically generate 10ms high pulse on testpin D5
     - periodically generate 100us high pulse on testpin D6
+    - idle in wait mode until next interrupt
     
   Supported Hardware:
     - Nucleo 8S207K8
@@ -33,6 +34,7 @@
 #define _MAIN_            // required for global variables
   #include "sw_clock.h"
 #undef _MAIN_
+#include "sw_timer.h"
 
 
 /*----------------------------------------------------------
@@ -57,15 +59,60 @@
 
 
 
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// static SW timer nodes
+sw_timer_t  timerLED, timerLongPulse, timerShortPulse;
+
+
+
 /////////////////
-//  main routine
+// timer callback: toggle LED. Called from TIM4 ISR
 /////////////////
-void main(void)
+void cb_LED(void *Ctx)
+{
+  (void) Ctx;
+  GPIO_WriteReverse(PORT_TEST, PIN_LED);
+
+} // cb_LED()
+
+
+
+/////////////////
+// timer callback: long pulse (blocking sleep [ms] in low power mode). Called from main loop
+/////////////////
+void cb_long_pulse(void *Ctx)
+{
+  (void) Ctx;
+  GPIO_WriteHigh(PORT_TEST, PIN_TEST1);
+  sleep_ms(10);
+  GPIO_WriteLow(PORT_TEST, PIN_TEST1);
+
+} // cb_long_pulse()
+
+
+
+/////////////////
+// timer callback: short pulse (blocking delay [us]). Called from main loop
+/////////////////
+void cb_short_pulse(void *Ctx)
 {
-  // for SW scheduler. Stagger calls
-  uint32_t  lastLED=0, lastLongPulse=PULSE_PERIOD/4, lastShortPulse=PULSE_PERIOD/2;
+  (void) Ctx;
+  GPIO_WriteHigh(PORT_TEST, PIN_TEST2);
+  delayMicroseconds(100);
+  GPIO_WriteLow(PORT_TEST, PIN_TEST2);
+
+} // cb_short_pulse()
+
 
 
+/////////////////
+//  main routine
+/////////////////
+void main(void)
+{
   /////////////
   // initialization
   /////////////
@@ -83,6 +130,17 @@ void main(void)
   // start 1ms clock via TIM4
   init_SW_clock();
 
+  // initialize SW timer wheel (ticked in TIM4 ISR)
+  sw_timer_init();
+
+  // start periodic timers. Stagger calls
+  sw_timer_setup(&timerLED, cb_LED, NULL, SW_TIMER_ISR);
+  sw_timer_setup(&timerLongPulse, cb_long_pulse, NULL, SW_TIMER_DEFERRED);
+  sw_timer_setup(&timerShortPulse, cb_short_pulse, NULL, SW_TIMER_DEFERRED);
+  sw_timer_start(&timerLED, LED_PERIOD, LED_PERIOD);
+  sw_timer_start(&timerLongPulse, PULSE_PERIOD/4, PULSE_PERIOD);
+  sw_timer_start(&timerShortPulse, PULSE_PERIOD/2, PULSE_PERIOD);
+
   // enable interrupts
   enableInterrupts();
 
@@ -92,50 +150,11 @@ void main(void)
   /////////////
   while (1)
   {
-    // check if 1ms has passed (reduce CPU load for multiple schedulers)
-    if (flagMilli() == TRUE)
-    {
-      // clear 1ms flag
-      clearFlagMilli();
-
-      // store current ms only once for consistency
-      uint32_t currTime = millis();
-
-
-      //////////
-      // task for LED blink
-      //////////
-      if (currTime - lastLED >= LED_PERIOD)
-      {
-        lastLED = currTime;
-        GPIO_WriteReverse(PORT_TEST, PIN_LED);
-      } // task LED
-
-
-      //////////
-      // task for long pulse (blocking delay [ms])
-      //////////
-      if (currTime - lastLongPulse > PULSE_PERIOD)
-      {
-        lastLongPulse = currTime;
-        GPIO_WriteHigh(PORT_TEST, PIN_TEST1);
-        delay(10);
-        GPIO_WriteLow(PORT_TEST, PIN_TEST1);
-      } // task long pulse
-
-
-      //////////
-      // task for short pulse (blocking delay [us])
-      //////////
-      if (currTime - lastShortPulse > PULSE_PERIOD)
-      {
-        lastShortPulse = currTime;
-        GPIO_WriteHigh(PORT_TEST, PIN_TEST2);
-        delayMicroseconds(100);
-        GPIO_WriteLow(PORT_TEST, PIN_TEST2);
-      } // task short pulse
-   
-    } // 1ms has passed
+    // call deferred timer callbacks
+    sw_timer_process();
+
+    // wait mode until next interrupt (1ms tick at latest)
+    wfi();
 
   } // main loop
   
@@ -28,6 +28,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm8s_it.h"
 #include "sw_clock.h"
+#include "sw_timer.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -85,9 +86,10 @@ INTERRUPT_HANDLER(TLI_IRQHandler, 0)
   */
 INTERRUPT_HANDLER(AWU_IRQHandler, 1)
 {
-  /* In order to detect unexpected events during development,
-     it is recommended to set a breakpoint on the following instruction.
-  */
+#if defined(SW_CLOCK_TICKLESS)
+  // call inline ISR handler from sw_clock.h
+  ISR_AWU_handler();
+#endif
 }
 
 /**
@@ -460,6 +462,9 @@ INTERRUPT_HANDLER(TIM4_UPD_OVF_IRQHandler, 23)
   // call inline ISR handler from sw_clock.h
   ISR_TIM4_handler();
 
+  // advance SW timer wheel
+  sw_timer_tick();
+
 }
 #endif /*STM8S903*/
 
@@ -5,13 +5,23 @@
   Functionality:
     - initialization:
       - configure UART @ 115.2kBaud / 8N1 
+      - measure putchar() and printf() runtime in CPU cycles via TIM2 (see "perf_counter.h")
     - main loop
       - read byte from UART and echo it. For convenience
         - use printf() and getchar()
-        - skip interrupts and FIFOs
+        - output via interrupt driven TX buffer, see UART_TX_BUFFER_SIZE in "platformio.ini"
+        - input via interrupt driven RX buffer, see UART_RX_BUFFER_SIZE in "platformio.ini"
     
   Supported Hardware:
     - Nucleo 8S207K8
+
+  Note:
+    - with blocking output each character stalls the main loop for ~87us (115.2kBaud)
+    - TX buffer high-water mark is printed to check buffer size
+    - RX errors (overrun, framing, buffer full) are counted and printed
+    - UART is accessed via SPL function pointers (env "nucleo_8s207k8_uart_ptr") or directly (env "nucleo_8s207k8"),
+      see "platformio.ini". Compare printed putchar() and printf() cycles for both modes. With TX buffer the runtime
+      is only CPU load, else it is dominated by the baudrate
   
 **********************/
 
@@ -24,7 +34,9 @@
 #include "stm8s_uart3.h"
 #include "stdio.h"
 #define _MAIN_            // required for global variables
+  #include "sw_clock.h"
   #include "uart_stdio.h"
+  #include "perf_counter.h"
 #undef _MAIN_
 
 
@@ -35,6 +47,13 @@
 // communication speed [Baud]
 #define BAUDRATE        115200L
 
+// number of putchar() and printf() measurements
+#define PERF_RUNS       8
+
+// measurement ids (= index in g_perfTable). Must be < PERF_NUM_IDS
+#define ID_PUTCHAR      0
+#define ID_PRINTF       1
+
 
 /*----------------------------------------------------------
     FUNCTIONS
@@ -46,6 +65,7 @@
 void main(void)
 {
   char      c;
+  uint8_t   i;
 
 
   /////////////
@@ -59,30 +79,66 @@ void main(void)
   CLK->CKDIVR = 0x00;
   CLK_SYSCLKConfig(CLK_PRESCALER_CPUDIV1);
 
+  // start 1ms clock via TIM4
+  init_SW_clock();
+
   // Configure UART3 for 115kBaud, 8N1
   UART3_Init(BAUDRATE, UART3_WORDLENGTH_8D, UART3_STOPBITS_1, UART3_PARITY_NO, UART3_MODE_TXRX_ENABLE);
 
-  // bind stdio input/output to UART3
+  // bind stdio input/output to UART3. Only used for UART_STDIO_PORT=0
   g_UART_SendData8 = &UART3_SendData8;
   g_UART_ReceiveData8 = &UART3_ReceiveData8;
   g_UART_GetFlagStatus = &UART3_GetFlagStatus;
+  g_UART_ITConfig = &UART3_ITConfig;
+
+  // enable RX interrupt for RX buffer
+  #if (UART_RX_BUFFER_SIZE > 0)
+    UART3_ITConfig(UART3_IT_RXNE_OR, ENABLE);
+  #endif
 
   // enable interrupts
   enableInterrupts();
 
+  // start TIM2 cycle counter and measure overhead
+  perf_init();
+
   // print greeting message
   printf("\npress any key\n\n");
 
+  // measure runtime of putchar() and printf() with 32 characters. With TX buffer start with empty buffer
+  for (i = 0; i < PERF_RUNS; i++)
+  {
+    uart_flush();
+    PERF_BEGIN(ID_PUTCHAR);
+    putchar('.');
+    PERF_END(ID_PUTCHAR);
+
+    uart_flush();
+    PERF_BEGIN(ID_PRINTF);
+    printf("0123456789012345678901234567890\n");
+    PERF_END(ID_PRINTF);
+  }
+  printf("putchar(): min %ld, max %ld cycles\n", (long) g_perfTable[ID_PUTCHAR].min, (long) g_perfTable[ID_PUTCHAR].max);
+  printf("printf() 32B: min %ld, max %ld cycles (%ldus)\n", (long) g_perfTable[ID_PRINTF].min, (long) g_perfTable[ID_PRINTF].max,
+    (long) (g_perfTable[ID_PRINTF].min / 16));
+  printf("(UART_STDIO_PORT=%d, UART_TX_BUFFER_SIZE=%d)\n\n", (int) UART_STDIO_PORT, (int) UART_TX_BUFFER_SIZE);
+
   /////////////
   // main loop
   /////////////
   while (1)
   {
     // if byte was received, echo response
-    if (UART3_GetFlagStatus(UART3_FLAG_RXNE))
+    if (uart_available())
     {
-      c = getchar();
+      c = (char) uart_read();
       printf("key '%c' pressed (code %d)\n", c, (int) c);  
+      #if (UART_TX_BUFFER_SIZE > 0)
+        printf("  TX buffer: max %d/%d, dropped %d\n", (int) g_UART_TxHighWater, (int) UART_TX_BUFFER_SIZE, (int) g_UART_TxDropped);
+      #endif
+      #if (UART_RX_BUFFER_SIZE > 0)
+        printf("  RX errors: overrun %d, framing %d, dropped %d\n", (int) g_UART_RxOverrun, (int) g_UART_RxFraming, (int) g_UART_RxDropped);
+      #endif
     }
    
   } // main loop
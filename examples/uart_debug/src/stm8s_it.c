@@ -27,6 +27,9 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm8s_it.h"
+#include "sw_clock.h"
+#include "uart_stdio.h"
+#include "perf_counter.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -268,9 +271,9 @@ INTERRUPT_HANDLER(TIM1_CAP_COM_IRQHandler, 12)
   */
  INTERRUPT_HANDLER(TIM2_UPD_OVF_BRK_IRQHandler, 13)
 {
-  /* In order to detect unexpected events during development,
-     it is recommended to set a breakpoint on the following instruction.
-  */
+  // call inline ISR handler from perf_counter.h
+  ISR_TIM2_handler();
+
 }
 
 /**
@@ -386,10 +389,10 @@ INTERRUPT_HANDLER(I2C_IRQHandler, 19)
   */
  INTERRUPT_HANDLER(UART3_TX_IRQHandler, 20)
 {
-    /* In order to detect unexpected events during development,
-       it is recommended to set a breakpoint on the following instruction.
-    */
-  }
+  // call inline ISR handler from uart_stdio.h
+  ISR_UART_TX_handler();
+
+}
 
 /**
   * @brief  UART3 RX interrupt routine.
@@ -398,10 +401,10 @@ INTERRUPT_HANDLER(I2C_IRQHandler, 19)
   */
  INTERRUPT_HANDLER(UART3_RX_IRQHandler, 21)
 {
-    /* In order to detect unexpected events during development,
-       it is recommended to set a breakpoint on the following instruction.
-    */
-  }
+  // call inline ISR handler from uart_stdio.h
+  ISR_UART_RX_handler();
+
+}
 #endif /*STM8S208 or STM8S207 or STM8AF52Ax or STM8AF62Ax */
 
 #if defined(STM8S207) || defined(STM8S007) || defined(STM8S208) || defined (STM8AF52Ax) || defined (STM8AF62Ax)
@@ -456,9 +459,9 @@ INTERRUPT_HANDLER(TIM6_UPD_OVF_TRG_IRQHandler, 23)
   */
 INTERRUPT_HANDLER(TIM4_UPD_OVF_IRQHandler, 23)
 {
-  /* In order to detect unexpected events during development,
-     it is recommended to set a breakpoint on the following instruction.
-  */
+  // call inline ISR handler from sw_clock.h
+  ISR_TIM4_handler();
+
 }
 #endif /*STM8S903*/
 